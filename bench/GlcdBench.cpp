@@ -0,0 +1,186 @@
+/*
+  GlcdBench.cpp - compares the C++ Glcd template with the C library on the
+  host emulator
+
+  Both draw the same scene on an emulated panel, covering every group of
+  calls of the class, the template on glcd::HostBus, the pin level bus of
+  the emulator. The bus traffic and the modeled PIC time come from the
+  emulator, the host time measures the CPU cost of the driver code itself.
+  Both run the algorithms of GLCD_Core.h, so the panels must end up
+  identical.
+
+    gcc -c -O2 -DGLCD_HOST -Iinclude src/GLCD.c src/GLCD_Host.c
+    g++ -O2 -DGLCD_HOST -Iinclude bench/GlcdBench.cpp GLCD.o GLCD_Host.o -o glcdbench
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "Glcd.hpp"
+#include "SystemFont5x7.h"
+#include "Arial14.h"
+#include "SystemFont5x7Latin.h"
+
+#ifndef BENCH_RUNS
+#define BENCH_RUNS 50
+#endif
+
+struct Result {
+    GLCD_HostStats stats;
+    double hostUs;  // host CPU time per run
+    uint8_t screen[DISPLAY_PAGES][DISPLAY_WIDTH];
+};
+
+/* 8 x 8 bitmap, drawn across a chip boundary and at the panel edges */
+static const uint8_t bitmap[2 + 8] = { 8, 8, 0x81, 0x42, 0x24, 0xFF, 0xFF, 0x24, 0x42, 0x81 };
+static const lcdPoint points[] = { { 70, 2 }, { 90, 20 }, { 110, 4 }, { 126, 30 } };
+static const uint8_t samples[] = { 10, 40, 80, 120, 160, 200, 240, 200, 160, 120, 80, 40 };
+
+static void scene_c(void)
+{
+    GLCD_SetRotation(GLCD_ROTATE_0);
+    GLCD_SetInverted(NON_INVERTED);
+    GLCD_ClearScreen(WHITE);
+    GLCD_FillRect(3, 5, 40, 20, BLACK);
+    GLCD_InvertRect(10, 2, 50, 30);
+    GLCD_DrawLine(0, 63, 127, 0, BLACK);
+    GLCD_DrawLine(5, 0, 20, 63, BLACK);
+    GLCD_DrawRoundRect(60, 10, 40, 30, 8, BLACK);
+    GLCD_DrawCircle(100, 45, 6, BLACK);
+    GLCD_DrawPolyline(points, 4, BLACK);
+    GLCD_PlotSamples(64, samples, 12, 16, BLACK);
+    GLCD_DrawBitmap(bitmap, 60, 50, BLACK);
+    GLCD_DrawBitmap(bitmap, 60, 60, BLACK);
+    GLCD_DrawBitmap(bitmap, 124, 20, BLACK);
+    GLCD_CopyRect(0, 0, 15, 15, 110, 48);
+    GLCD_ScrollRect(64, 0, 63, 15, 0, -3, WHITE);
+    GLCD_SelectFont(System5x7);
+    GLCD_GotoXY(2, 40);
+    GLCD_Puts("Hello 123");
+    GLCD_PrintNumber(-42);
+    GLCD_SelectFont(Arial_14);
+    GLCD_GotoXY(60, 45);
+    GLCD_Puts("Abc");
+    GLCD_SelectFont(System5x7Latin);
+    GLCD_GotoXY(2, 56);
+    GLCD_PutsUtf8("Bär");
+    GLCD_SelectFont(System5x7);
+    GLCD_TextBox(30, 26, 40, 15, "wrapped text in a box", GLCD_TEXT_WRAP | GLCD_TEXT_ELLIPSIS);
+    GLCD_SetRotation(GLCD_ROTATE_90);
+    GLCD_GotoXY(0, 0);
+    GLCD_Puts("Up");
+    GLCD_SetRotation(GLCD_ROTATE_0);
+    GLCD_SetDot(127, 63, BLACK);
+#ifdef GLCD_FRAMEBUFFER
+    GLCD_Flush();
+#endif
+}
+
+typedef glcd::Glcd<glcd::HostBus> Lcd;
+
+static void scene_cpp(Lcd &lcd)
+{
+    lcd.setRotation(GLCD_ROTATE_0);
+    lcd.setInverted(NON_INVERTED);
+    lcd.clearScreen(WHITE);
+    lcd.fillRect(3, 5, 40, 20, BLACK);
+    lcd.invertRect(10, 2, 50, 30);
+    lcd.drawLine(0, 63, 127, 0, BLACK);
+    lcd.drawLine(5, 0, 20, 63, BLACK);
+    lcd.drawRoundRect(60, 10, 40, 30, 8, BLACK);
+    lcd.drawCircle(100, 45, 6, BLACK);
+    lcd.drawPolyline(points, 4, BLACK);
+    lcd.plotSamples(64, samples, 12, 16, BLACK);
+    lcd.drawBitmap(bitmap, 60, 50, BLACK);
+    lcd.drawBitmap(bitmap, 60, 60, BLACK);
+    lcd.drawBitmap(bitmap, 124, 20, BLACK);
+    lcd.copyRect(0, 0, 15, 15, 110, 48);
+    lcd.scrollRect(64, 0, 63, 15, 0, -3, WHITE);
+    lcd.selectFont(System5x7);
+    lcd.gotoXY(2, 40);
+    lcd.puts("Hello 123");
+    lcd.printNumber(-42);
+    lcd.selectFont(Arial_14);
+    lcd.gotoXY(60, 45);
+    lcd.puts("Abc");
+    lcd.selectFont(System5x7Latin);
+    lcd.gotoXY(2, 56);
+    lcd.putsUtf8("Bär");
+    lcd.selectFont(System5x7);
+    lcd.textBox(30, 26, 40, 15, "wrapped text in a box", GLCD_TEXT_WRAP | GLCD_TEXT_ELLIPSIS);
+    lcd.setRotation(GLCD_ROTATE_90);
+    lcd.gotoXY(0, 0);
+    lcd.puts("Up");
+    lcd.setRotation(GLCD_ROTATE_0);
+    lcd.setDot(127, 63, BLACK);
+#ifdef GLCD_FRAMEBUFFER
+    lcd.flush();
+#endif
+}
+
+template <class F>
+static void run(Result &r, F scene)
+{
+    std::chrono::steady_clock::duration host(0);
+
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        scene(true);    // power on and init, not measured
+        GLCD_HostResetStats();
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        scene(false);
+        host += std::chrono::steady_clock::now() - t;
+    }
+    r.stats = *GLCD_HostGetStats();
+    r.hostUs = std::chrono::duration<double, std::micro>(host).count() / BENCH_RUNS;
+    for (uint8_t page = 0; page < DISPLAY_PAGES; page++) {
+        for (uint16_t x = 0; x < DISPLAY_WIDTH; x++)
+            r.screen[page][x] = GLCD_HostByte(x, page);
+    }
+}
+
+static void print(const char *name, const Result &r)
+{
+    printf("%-6s %8u %8u %8u %8u %8u %10.1f %10.2f\n", name,
+            r.stats.commands, r.stats.writes, r.stats.reads, r.stats.polls,
+            r.stats.violations, r.stats.time / 1e6, r.hostUs);
+}
+
+int main(void)
+{
+    static Result c, cpp;
+    static Lcd lcd;
+
+    run(c, [](bool init) {
+        if (init) {
+            GLCD_HostPowerOn();
+            GLCD_Init(NON_INVERTED);
+        } else {
+            scene_c();
+        }
+    });
+    run(cpp, [](bool init) {
+        if (init) {
+            GLCD_HostPowerOn();
+            lcd.init(NON_INVERTED);
+        } else {
+            scene_cpp(lcd);
+        }
+    });
+
+    printf("%lu MHz, %d runs\n", (unsigned long) (_XTAL_FREQ / 1000000UL), BENCH_RUNS);
+    printf("%-6s %8s %8s %8s %8s %8s %10s %10s\n", "path",
+            "commands", "writes", "reads", "polls", "errors", "pic us", "host us");
+    print("C", c);
+    print("C++", cpp);
+
+    if (memcmp(c.screen, cpp.screen, sizeof (c.screen)) != 0) {
+        printf("screens differ\n");
+        return 1;
+    }
+    return c.stats.violations || cpp.stats.violations;
+}
@@ -0,0 +1,586 @@
+/*
+  GlcdPrimitives.c - bus cost of each drawing primitive on the host emulator
+
+  Runs every primitive on a freshly initialized panel and reports the bus
+  traffic and the modeled PIC time from the emulator, at _XTAL_FREQ (set it
+  with -D_XTAL_FREQ=16000000UL and so on). The results can be saved as a
+  baseline, and a later run compared with it fails when any primitive got
+  worse by more than the threshold:
+
+    gcc -O2 -DGLCD_HOST -Iinclude src/GLCD.c src/GLCD_Host.c src/GLCD_Widgets.c \
+        src/GLCD_Dither.c bench/GlcdPrimitives.c -o glcdprim
+    ./glcdprim -w bench/baseline.txt       save a baseline
+    ./glcdprim -b bench/baseline.txt -t 2  compare, 2 % threshold (default 5)
+
+  The emulator is deterministic, so the figures only change with the code,
+  the clock or the build options. The baseline file holds one section per
+  clock and options, headed by a config line; -w replaces the section of
+  the build and a run is only compared against its own section:
+
+    gcc ... -DGLCD_FRAMEBUFFER ... -o glcdprim-fb
+    ./glcdprim-fb -w bench/baseline.txt    adds the framebuffer section
+
+  A primitive measured but missing from the section, or listed but no
+  longer measured, fails the comparison too until the baseline is rewritten.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GLCD.h"
+#include "GLCD_Widgets.h"
+#include "GLCD_Dither.h"
+#include "SystemFont5x7.h"
+#include "Arial14.h"
+#include "SystemFont5x7Latin.h"
+
+#define MAX_NAME 32
+
+typedef struct {
+    const char *name;
+    void (*setup)(void);    // not measured
+    void (*draw)(void);
+    uint8_t raw;            // frame buffer left alone around setup and draw
+} Primitive;
+
+typedef struct {
+    char name[MAX_NAME];
+    uint32_t commands, writes, reads, polls, violations;
+    double us;
+} Result;
+
+static uint8_t bitmap[2 + 32 * 3];   // 32 x 24, width and height first
+
+static void bitmapInit(void)
+{
+    uint8_t i;
+
+    bitmap[0] = 32;
+    bitmap[1] = 24;
+    for (i = 0; i < 32 * 3; i++)
+        bitmap[2 + i] = (uint8_t) (i * 37 + 0x5A);
+}
+
+/* Pulls the bitmap from memory like a flash driver would, a chunk at a time */
+static size_t streamPos;
+
+static uint8_t streamRead(void *source, uint8_t *buf, uint8_t n)
+{
+    memcpy(buf, (const uint8_t *) source + streamPos, n);
+    streamPos += n;
+    return n;
+}
+
+static void streamAligned(void) { streamPos = 0; GLCD_DrawBitmapStream(streamRead, bitmap, 16, 16, BLACK); }
+static void streamUnaligned(void) { streamPos = 0; GLCD_DrawBitmapStream(streamRead, bitmap, 16, 13, BLACK); }
+
+/*
+ * Full screen diagonal gray ramp, dithered as the rows arrive. A dither
+ * covers at most 255 columns, so a wider panel takes two side by side.
+ */
+#define RAMP_PARTS ((DISPLAY_WIDTH + 254) / 255)
+#define RAMP_WIDTH (DISPLAY_WIDTH / RAMP_PARTS)
+
+static void ditherRamp(int16_t *error)
+{
+    uint8_t gray[DISPLAY_WIDTH], band[DISPLAY_WIDTH];
+    lcdDither dither[RAMP_PARTS];
+    uint16_t x;
+    uint8_t y, i;
+
+    for (i = 0; i < RAMP_PARTS; i++)
+        GLCD_DitherInit(&dither[i], i * RAMP_WIDTH, 0, RAMP_WIDTH, band + i * RAMP_WIDTH,
+                error ? error + i * (RAMP_WIDTH + 1) : NULL);
+    for (y = 0; y < DISPLAY_HEIGHT; y++) {
+        for (x = 0; x < DISPLAY_WIDTH; x++)
+            gray[x] = (uint8_t) ((x + y) * 255 / (DISPLAY_WIDTH + DISPLAY_HEIGHT - 2));
+        for (i = 0; i < RAMP_PARTS; i++)
+            GLCD_DitherRow(&dither[i], gray + i * RAMP_WIDTH);
+    }
+}
+
+static void ditherBayer(void) { ditherRamp(NULL); }
+
+static void ditherFloyd(void)
+{
+    int16_t error[RAMP_PARTS * (RAMP_WIDTH + 1)];
+
+    ditherRamp(error);
+}
+
+static void systemFont(void) { GLCD_SelectFont(System5x7); }
+static void arialFont(void) { GLCD_SelectFont(Arial_14); }
+static void latinFont(void) { GLCD_SelectFont(System5x7Latin); }
+static void portrait(void) { GLCD_SetRotation(GLCD_ROTATE_90); }
+static void systemPortrait(void) { systemFont(); portrait(); }
+static void arialPortrait(void) { arialFont(); portrait(); }
+
+/* Chips left in reset by any GLCD_Init(), a failed run */
+static uint8_t stuck;
+
+/* From power on: the reset wait, the chips turned on and the first clear */
+static void initPanel(void)
+{
+    GLCD_HostPowerOn();
+    stuck |= GLCD_Init(NON_INVERTED);
+}
+
+static void clearScreen(void) { GLCD_ClearScreen(BLACK); }
+static void fillAligned(void) { GLCD_FillRect(8, 8, 63, 31, BLACK); }
+static void fillUnaligned(void) { GLCD_FillRect(5, 3, 63, 31, BLACK); }
+static void invertAligned(void) { GLCD_InvertRect(8, 8, 63, 31); }
+static void invertUnaligned(void) { GLCD_InvertRect(5, 3, 63, 31); }
+static void lineHorizontal(void) { GLCD_DrawLine(0, 20, DISPLAY_WIDTH - 1, 20, BLACK); }
+static void lineVertical(void) { GLCD_DrawLine(40, 0, 40, DISPLAY_HEIGHT - 1, BLACK); }
+static void lineDiagonal(void) { GLCD_DrawLine(0, 0, DISPLAY_HEIGHT - 1, DISPLAY_HEIGHT - 1, BLACK); }
+static void lineShallow(void) { GLCD_DrawLine(0, 10, DISPLAY_WIDTH - 1, 40, BLACK); }
+static void lineSteep(void) { GLCD_DrawLine(10, 0, 40, DISPLAY_HEIGHT - 1, BLACK); }
+static void roundRect(void) { GLCD_DrawRoundRect(10, 5, 100, 50, 10, BLACK); }
+static void bitmapAligned(void) { GLCD_DrawBitmap(bitmap, 16, 16, BLACK); }
+static void bitmapUnaligned(void) { GLCD_DrawBitmap(bitmap, 16, 13, BLACK); }
+
+/* 128 samples of a wave, for the trace primitives */
+static uint8_t samples[128];
+static lcdPoint points[128];
+
+static void samplesInit(void)
+{
+    uint8_t i, t;
+
+    for (i = 0; i < 128; i++) {
+        t = i % 32;
+        samples[i] = (t < 16 ? t * 16 : (32 - t) * 16) + i * 7 % 23;
+        points[i].x = i;
+        points[i].y = DISPLAY_HEIGHT - 1 - (samples[i] >> 2);
+    }
+}
+
+static void linesWave(void)
+{
+    uint8_t i;
+
+    for (i = 1; i < 128; i++)
+        GLCD_DrawLine(points[i - 1].x, points[i - 1].y, points[i].x, points[i].y, BLACK);
+}
+
+static void polylineWave(void) { GLCD_DrawPolyline(points, 128, BLACK); }
+static void plotWave(void) { GLCD_PlotSamples(0, samples, 128, 64, BLACK); }
+
+/*
+ * A 128 x 32 gray trend background: level bands with a dark trace. One
+ * measured cycle is the three ticks that show each plane its share of time.
+ */
+static lcdGray gray;
+static uint8_t grayPlanes[2 * 128 * 4];
+
+static void grayLayer(void)
+{
+    uint8_t i;
+
+    GLCD_GrayInit(&gray, 0, 4, 128, 4, grayPlanes);
+    GLCD_GrayFillRect(&gray, 0, 32, 127, 7, GLCD_GRAY_LIGHT);
+    GLCD_GrayFillRect(&gray, 0, 48, 127, 7, GLCD_GRAY_LIGHT);
+    for (i = 0; i < 128; i++)
+        GLCD_GraySetDot(&gray, i, 40 + samples[i] / 16, GLCD_GRAY_DARK);
+    for (i = 0; i < 3; i++)
+        GLCD_GrayTick(&gray);
+}
+
+static void grayCycle(void)
+{
+    GLCD_GrayTick(&gray);
+    GLCD_GrayTick(&gray);
+    GLCD_GrayTick(&gray);
+}
+
+static lcdChart chart;
+static uint8_t chartRing[2 * 100];
+
+/* 100 x 32 strip chart, full so that every sample scrolls it */
+static void chartFull(void)
+{
+    uint8_t i;
+
+    GLCD_ChartInit(&chart, 14, 2, 100, 4, chartRing, 8, 25);
+    for (i = 0; i < 100; i++)
+        GLCD_ChartAdd(&chart, i * 3 % 100, 100);
+}
+
+static void chartSample(void) { GLCD_ChartAdd(&chart, 42, 100); }
+
+static lcdBigNum bigNum;
+
+/* Four 32 row digits with a sign and a decimal, one digit changes per step */
+static void bigNumShown(void)
+{
+    GLCD_BigNumInit(&bigNum, 0, 0, 4, 4, 1, GLCD_WIDGET_SIGNED);
+    GLCD_BigNumSet(&bigNum, -1234);
+}
+
+static void bigNumStep(void) { GLCD_BigNumSet(&bigNum, -1235); }
+static void bigNumAll(void) { GLCD_BigNumSet(&bigNum, 5678); }
+
+static void putsText(void)
+{
+    GLCD_GotoXY(0, 8);
+    GLCD_Puts("The quick brown fox");
+}
+
+/* As long as putsText(), with a third of the letters outside ASCII */
+static void putsLatin(void)
+{
+    GLCD_GotoXY(0, 8);
+    GLCD_PutsUtf8("Der größte Bär, ¿señor?");
+}
+
+/* A line that fits across the panel in portrait */
+static void putsPortrait(void)
+{
+    GLCD_GotoXY(0, 8);
+    GLCD_Puts("Quick fox");
+}
+
+/* A paragraph wrapped and centered in a box of four lines, cut with an ellipsis */
+static void textBox(void)
+{
+    GLCD_TextBox(0, 0, 83, 31, "The quick brown fox jumps over the lazy dog and runs off into the woods",
+            GLCD_ALIGN_CENTER | GLCD_TEXT_WRAP | GLCD_TEXT_ELLIPSIS);
+}
+
+/* Eight lines of text, scrolled up by one line or by one pixel */
+static void menuText(void)
+{
+    uint8_t line;
+
+    GLCD_SelectFont(System5x7);
+    for (line = 0; line < 8; line++) {
+        GLCD_GotoXY(0, line * 8);
+        GLCD_Puts("Menu item text");
+    }
+}
+
+static void scrollLine(void) { GLCD_ScrollRect(0, 0, 83, 63, 0, -8, WHITE); }
+static void scrollPixel(void) { GLCD_ScrollRect(0, 0, 83, 63, 0, -1, WHITE); }
+static void scrollLeft(void) { GLCD_ScrollRect(0, 0, 83, 63, -4, 0, WHITE); }
+
+#ifdef GLCD_FRAMEBUFFER
+/* One budgeted call of the output engine with the whole frame still to send */
+static void dirtyFrame(void) { GLCD_ClearScreen(BLACK); }
+static void serviceOnce(void) { GLCD_Service(); }
+#endif
+
+static const Primitive primitives[] = {
+    { "Init", NULL, initPanel, 0 },
+    { "ClearScreen", NULL, clearScreen, 0 },
+    { "FillRect/aligned", NULL, fillAligned, 0 },
+    { "FillRect/unaligned", NULL, fillUnaligned, 0 },
+    { "InvertRect/aligned", NULL, invertAligned, 0 },
+    { "InvertRect/unaligned", NULL, invertUnaligned, 0 },
+    { "DrawLine/horizontal", NULL, lineHorizontal, 0 },
+    { "DrawLine/vertical", NULL, lineVertical, 0 },
+    { "DrawLine/diagonal", NULL, lineDiagonal, 0 },
+    { "DrawLine/shallow", NULL, lineShallow, 0 },
+    { "DrawLine/steep", NULL, lineSteep, 0 },
+    { "DrawRoundRect", NULL, roundRect, 0 },
+    { "DrawBitmap/aligned", NULL, bitmapAligned, 0 },
+    { "DrawBitmap/unaligned", NULL, bitmapUnaligned, 0 },
+    { "BitmapStream/aligned", NULL, streamAligned, 0 },
+    { "BitmapStream/unaligned", NULL, streamUnaligned, 0 },
+    { "Puts/System5x7", systemFont, putsText, 0 },
+    { "Puts/Arial14", arialFont, putsText, 0 },
+    { "Puts/Latin", latinFont, putsText, 0 },
+    { "PutsUtf8/Latin", latinFont, putsLatin, 0 },
+    { "Puts/System5x7-90", systemPortrait, putsPortrait, 0 },
+    { "Puts/Arial14-90", arialPortrait, putsPortrait, 0 },
+    { "DrawBitmap/90", portrait, bitmapAligned, 0 },
+    { "Puts/menu", NULL, menuText, 0 },
+    { "TextBox/System5x7", systemFont, textBox, 0 },
+    { "TextBox/Arial14", arialFont, textBox, 0 },
+    { "ScrollRect/line", menuText, scrollLine, 0 },
+    { "ScrollRect/pixel", menuText, scrollPixel, 0 },
+    { "ScrollRect/left", menuText, scrollLeft, 0 },
+    { "Dither/bayer", NULL, ditherBayer, 0 },
+    { "Dither/floyd", NULL, ditherFloyd, 0 },
+    { "GrayTick/cycle", grayLayer, grayCycle, 0 },
+    { "DrawLine/wave", NULL, linesWave, 0 },
+    { "DrawPolyline/wave", NULL, polylineWave, 0 },
+    { "PlotSamples/wave", NULL, plotWave, 0 },
+    { "ChartAdd/scroll", chartFull, chartSample, 0 },
+    { "BigNumSet/digit", bigNumShown, bigNumStep, 0 },
+    { "BigNumSet/all", bigNumShown, bigNumAll, 0 },
+#ifdef GLCD_FRAMEBUFFER
+    { "Service/budget", dirtyFrame, serviceOnce, 1 },
+#endif
+};
+
+#define PRIMITIVE_COUNT (sizeof (primitives) / sizeof (primitives[0]))
+
+/* Build options that change the figures, a baseline only applies to the same ones */
+static const char config[] = ""
+#ifdef GLCD_FRAMEBUFFER
+    " framebuffer"
+#endif
+#ifdef GLCD_DOUBLE_BUFFER
+    " double-buffer"
+#endif
+#ifdef GLCD_BUSY_ELISION
+    " busy-elision"
+#endif
+#ifdef GLCD_BUS_SPI
+    " spi"
+#endif
+#ifdef GLCD_BUS_MEMORY
+    " memory"
+#endif
+    ;
+
+static void configName(char *buf, size_t size)
+{
+    snprintf(buf, size, "%lu-MHz %ux%u%s", (unsigned long) (_XTAL_FREQ / 1000000UL),
+            DISPLAY_WIDTH, DISPLAY_HEIGHT, config);
+}
+
+static void measure(const Primitive *p, Result *r)
+{
+    const GLCD_HostStats *stats;
+
+    GLCD_HostPowerOn();
+    stuck |= GLCD_Init(NON_INVERTED);
+    GLCD_SetRotation(GLCD_ROTATE_0);
+    if (p->setup)
+        p->setup();
+#ifdef GLCD_FRAMEBUFFER
+    if (!p->raw)
+        GLCD_Flush();
+#endif
+    GLCD_HostResetStats();
+    p->draw();
+#ifdef GLCD_FRAMEBUFFER
+    if (!p->raw)
+        GLCD_Flush();
+#endif
+    stats = GLCD_HostGetStats();
+
+    snprintf(r->name, sizeof (r->name), "%s", p->name);
+    r->commands = stats->commands;
+    r->writes = stats->writes;
+    r->reads = stats->reads;
+    r->polls = stats->polls;
+    r->violations = stats->violations;
+    r->us = stats->time / 1e6;
+}
+
+/*
+ * A chip that never leaves reset: GLCD_Init() has to give up on it, report
+ * it and leave it out of the drawing that follows, which the other chips
+ * still show. Returns 0 when that holds.
+ */
+static int heldChip(void)
+{
+    uint8_t held = 1 << (GLCD_CHIP_COUNT - 1);
+
+    GLCD_HostPowerOn();
+    GLCD_HostHoldReset(held);
+    if (GLCD_Init(NON_INVERTED) != held)
+        return 1;
+    GLCD_FillRect(0, 0, DISPLAY_WIDTH - 1, 7, BLACK);
+#ifdef GLCD_FRAMEBUFFER
+    GLCD_Flush();
+#endif
+    return GLCD_HostPixel(0, 0) != 1;
+}
+
+/* True when line starts the section of the baseline taken with config name */
+static int isSection(const char *line, const char *name)
+{
+    size_t n = strlen(name);
+
+    return strncmp(line, "config ", 7) == 0 && strncmp(line + 7, name, n) == 0
+            && (line[7 + n] == '\n' || line[7 + n] == 0);
+}
+
+/*
+ * Replaces the section for this build in the baseline file in place, keeping
+ * the ones taken with other clocks or options.
+ */
+static int writeBaseline(const char *path, const Result *results)
+{
+    char name[64], line[160];
+    char *kept = NULL;
+    size_t size = 0, used = 0, at = 0, n, i;
+    int skip = 0, found = 0;
+    FILE *f;
+
+    configName(name, sizeof (name));
+    f = fopen(path, "r");
+    if (f) {
+        while (fgets(line, sizeof (line), f)) {
+            if (strncmp(line, "config ", 7) == 0) {
+                skip = isSection(line, name);
+                if (skip && !found) {
+                    found = 1;
+                    at = used;
+                }
+            }
+            if (skip)
+                continue;
+            n = strlen(line);
+            if (used + n + 1 > size) {
+                size = 2 * size + sizeof (line);
+                kept = realloc(kept, size);
+                if (!kept) {
+                    perror(path);
+                    fclose(f);
+                    return 1;
+                }
+            }
+            memcpy(kept + used, line, n + 1);
+            used += n;
+        }
+        fclose(f);
+    }
+    f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        free(kept);
+        return 1;
+    }
+    if (!found)
+        at = used;
+    fwrite(kept, 1, at, f);
+    fprintf(f, "config %s\n", name);
+    for (i = 0; i < PRIMITIVE_COUNT; i++) {
+        const Result *r = &results[i];
+        fprintf(f, "%s %u %u %u %u %.1f\n", r->name,
+                r->commands, r->writes, r->reads, r->polls, r->us);
+    }
+    fwrite(kept + at, 1, used - at, f);
+    free(kept);
+    fclose(f);
+    return 0;
+}
+
+/* A metric regresses when it grows by more than threshold percent */
+static int worse(double now, double base, double threshold)
+{
+    return now > base * (1.0 + threshold / 100.0) + 1e-9;
+}
+
+static int compareBaseline(const char *path, const Result *results, double threshold)
+{
+    char line[160], name[64], want[64];
+    static uint8_t seen[PRIMITIVE_COUNT];
+    Result base;
+    FILE *f;
+    size_t i;
+    int failed = 0, found = 0;
+
+    f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    configName(want, sizeof (want));
+    while (!found && fgets(line, sizeof (line), f))
+        found = isSection(line, want);
+    if (!found) {
+        printf("%s: no baseline for %s\n", path, want);
+        fclose(f);
+        return 1;
+    }
+    while (fgets(line, sizeof (line), f) && strncmp(line, "config ", 7) != 0) {
+        if (sscanf(line, "%63s %u %u %u %u %lf", name, &base.commands, &base.writes,
+                &base.reads, &base.polls, &base.us) != 6)
+            continue;
+        for (i = 0; i < PRIMITIVE_COUNT && strcmp(results[i].name, name) != 0; i++);
+        if (i == PRIMITIVE_COUNT) {
+            printf("STALE      %-22s in the baseline but no longer measured\n", name);
+            failed = 1;
+            continue;
+        }
+        seen[i] = 1;
+        const Result *r = &results[i];
+        if (worse(r->commands, base.commands, threshold)
+                || worse(r->writes, base.writes, threshold)
+                || worse(r->reads, base.reads, threshold)
+                || worse(r->polls, base.polls, threshold)
+                || worse(r->us, base.us, threshold)) {
+            printf("REGRESSION %-22s %u/%u/%u/%u %.1f us, baseline %u/%u/%u/%u %.1f us\n",
+                    r->name, r->commands, r->writes, r->reads, r->polls, r->us,
+                    base.commands, base.writes, base.reads, base.polls, base.us);
+            failed = 1;
+        }
+    }
+    fclose(f);
+    for (i = 0; i < PRIMITIVE_COUNT; i++) {
+        if (!seen[i]) {
+            printf("MISSING    %-22s not in the baseline\n", results[i].name);
+            failed = 1;
+        }
+    }
+    return failed;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-w baseline] [-b baseline] [-t percent]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    static Result results[PRIMITIVE_COUNT];
+    const char *save = NULL, *compare = NULL;
+    double threshold = 5.0;
+    char name[64];
+    size_t i;
+    int failed = 0;
+
+    for (i = 1; i < (size_t) argc; i++) {
+        if (i + 1 >= (size_t) argc)
+            usage(argv[0]);
+        if (strcmp(argv[i], "-w") == 0)
+            save = argv[++i];
+        else if (strcmp(argv[i], "-b") == 0)
+            compare = argv[++i];
+        else if (strcmp(argv[i], "-t") == 0)
+            threshold = atof(argv[++i]);
+        else
+            usage(argv[0]);
+    }
+
+    bitmapInit();
+    samplesInit();
+    configName(name, sizeof (name));
+    printf("%s\n", name);
+    printf("%-22s %8s %8s %8s %8s %8s %10s\n", "primitive",
+            "commands", "writes", "reads", "polls", "errors", "pic us");
+    for (i = 0; i < PRIMITIVE_COUNT; i++) {
+        Result *r = &results[i];
+
+        measure(&primitives[i], r);
+        printf("%-22s %8u %8u %8u %8u %8u %10.1f\n", r->name,
+                r->commands, r->writes, r->reads, r->polls, r->violations, r->us);
+        if (r->violations)
+            failed = 1;
+    }
+
+    if (stuck) {
+        printf("chips 0x%02X did not leave reset\n", stuck);
+        failed = 1;
+    }
+    if (heldChip()) {
+        printf("a chip held in reset stops the panel\n");
+        failed = 1;
+    }
+    if (save && writeBaseline(save, results))
+        failed = 1;
+    if (compare && compareBaseline(compare, results, threshold))
+        failed = 1;
+    return failed;
+}
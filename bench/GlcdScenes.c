@@ -0,0 +1,632 @@
+/*
+  GlcdScenes.c - golden image and bus trace checks on the host emulator
+
+  Renders scene scripts on the emulated panel and compares the panel with
+  the golden image stored next to each script (scene.scn -> scene.pbm):
+
+    gcc -O2 -DGLCD_HOST -Iinclude src/GLCD.c src/GLCD_Host.c src/GLCD_Widgets.c \
+        bench/GlcdScenes.c -o glcdscenes
+    ./glcdscenes scene.scn...       compare with the golden images
+    ./glcdscenes -u scene.scn...    write the golden images
+
+  bench/scenes holds the corpus.
+
+  The bus transactions of every scene can be recorded with -r trace and
+  compared with a recording from another build with -d trace. The diff
+  counts the transactions of each kind before and after and points at the
+  first command, write or read that differs. Status reads are counted but
+  not compared, since how often a chip is polled is a matter of timing.
+
+  Scene scripts have one command per line, # starts a comment:
+
+    clear black|white               GLCD_ClearScreen
+    inverted 0|1                    GLCD_SetInverted
+    fill x y w h color              GLCD_FillRect
+    invert x y w h                  GLCD_InvertRect
+    line x1 y1 x2 y2 color          GLCD_DrawLine
+    rect x y w h color              GLCD_DrawRect
+    roundrect x y w h r color       GLCD_DrawRoundRect
+    dot x y color                   GLCD_SetDot
+    bitmap x y color                GLCD_DrawBitmap, 32 x 24 test pattern
+    stream memory|file x y color    GLCD_DrawBitmapStream of the test pattern, from
+                                    memory or from a temporary file
+    font system|arial|latin [color] GLCD_SelectFontEx, latin is the range font System5x7Latin
+    goto x y                        GLCD_GotoXY
+    rotate 0|90|270                 GLCD_SetRotation, later coordinates are rotated
+    puts text to the end of line    GLCD_Puts
+    putsutf8 text                   GLCD_PutsUtf8
+    textbox x y w h flags text      GLCD_TextBox with the rest of the line, | for a newline
+    polyline color x y x y...       GLCD_DrawPolyline
+    plot x0 yscale n color          GLCD_PlotSamples with n samples of a test wave
+    copy x y w h dx dy              GLCD_CopyRect to dx, dy
+    scroll x y w h dx dy color      GLCD_ScrollRect
+    gray x page w h bayer|floyd     dithered test image, a gradient with a ring
+    bar x y w h flags value...      GLCD_BarInit, then GLCD_BarSet with each value of 100
+    level x y w h n flags value...  GLCD_LevelInit with n segments, then GLCD_LevelSet
+    gauge x y r value...            GLCD_GaugeInit, then GLCD_GaugeSet
+    chart x page w pages gr gc n    GLCD_ChartInit, then n samples of a test wave
+    bignum x page pages digits decimals flags value...
+                                    GLCD_BigNumInit, then GLCD_BigNumSet
+
+  flags are the GLCD_WIDGET_xx bits as a number.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "GLCD.h"
+#include "GLCD_Widgets.h"
+#include "GLCD_Dither.h"
+#include "SystemFont5x7.h"
+#include "Arial14.h"
+#include "SystemFont5x7Latin.h"
+
+#define MAX_LINE 256
+#define MAX_PATH 512
+
+typedef struct {
+    uint8_t chip;
+    char kind;
+    uint8_t value;
+} Access;
+
+typedef struct {
+    Access *log;
+    size_t count, size;
+} Trace;
+
+static Trace current;
+static uint8_t bitmap[2 + 32 * 3];   // 32 x 24, width and height first
+
+static void bitmapInit(void)
+{
+    uint8_t i;
+
+    bitmap[0] = 32;
+    bitmap[1] = 24;
+    for (i = 0; i < 32 * 3; i++)
+        bitmap[2 + i] = (uint8_t) (i * 37 + 0x5A);
+}
+
+/* Bitmap stream stand-ins for an external flash */
+typedef struct {
+    const uint8_t *data;
+    size_t pos;
+} MemorySource;
+
+static uint8_t readMemory(void *source, uint8_t *buf, uint8_t n)
+{
+    MemorySource *m = source;
+
+    if (n > GLCD_STREAM_CHUNK) {
+        fprintf(stderr, "stream: request of %u bytes\n", n);
+        exit(2);
+    }
+    memcpy(buf, m->data + m->pos, n);
+    m->pos += n;
+    return n;
+}
+
+static uint8_t readFile(void *source, uint8_t *buf, uint8_t n)
+{
+    return (uint8_t) fread(buf, 1, n, (FILE *) source);
+}
+
+static void record(uint8_t chip, char kind, uint8_t value)
+{
+    if (current.count == current.size) {
+        current.size = current.size ? current.size * 2 : 4096;
+        current.log = realloc(current.log, current.size * sizeof (Access));
+        if (!current.log) {
+            perror("trace");
+            exit(2);
+        }
+    }
+    current.log[current.count].chip = chip;
+    current.log[current.count].kind = kind;
+    current.log[current.count].value = value;
+    current.count++;
+}
+
+static int color(const char *s, uint8_t *c)
+{
+    if (strcmp(s, "black") == 0)
+        *c = BLACK;
+    else if (strcmp(s, "white") == 0)
+        *c = WHITE;
+    else
+        return 0;
+    return 1;
+}
+
+/* Chart test samples, 0 to 100: a triangle with period 40 and some ripple */
+static int wave(int i)
+{
+    int t = i % 40;
+
+    return (t < 20 ? t * 4 : (40 - t) * 4) + (i * 7) % 11 * 2;
+}
+
+/* Gray test image: left to right ramp, a white ring with a black disc inside */
+static uint8_t grayPixel(int x, int y, int w, int h)
+{
+    int dx = 2 * x - w, dy = 2 * y - h, r = dx * dx + dy * dy, rmax = h * h;
+
+    if (r < rmax / 9)
+        return 0;
+    if (r < rmax / 3)
+        return 255;
+    return (uint8_t) (x * 255 / (w - 1));
+}
+
+/* Parses the values after the first skip numbers of a widget line */
+static int values(const char *line, int skip, int *v, int max)
+{
+    int n = 0, used;
+
+    while (n < max && sscanf(line, "%d%n", &v[n], &used) == 1) {
+        line += used;
+        n++;
+    }
+    return n > skip ? n - skip : 0;
+}
+
+/* Runs one script line, returns 0 if it can't be parsed */
+static int command(char *line)
+{
+    char op[16], a[16] = "", b[16] = "";
+    int v[32], n, i;
+    uint8_t c = BLACK;
+
+    if (sscanf(line, "%15s%n", op, &n) != 1 || op[0] == '#')
+        return 1;
+    line += n;
+
+    if (strcmp(op, "puts") == 0) {
+        if (*line == ' ')
+            line++;
+        GLCD_Puts(line);
+    } else if (strcmp(op, "putsutf8") == 0) {
+        if (*line == ' ')
+            line++;
+        GLCD_PutsUtf8(line);
+    } else if (strcmp(op, "clear") == 0) {
+        if (sscanf(line, "%15s", a) != 1 || !color(a, &c))
+            return 0;
+        GLCD_ClearScreen(c);
+    } else if (strcmp(op, "inverted") == 0) {
+        if (sscanf(line, "%d", &v[0]) != 1)
+            return 0;
+        GLCD_SetInverted(v[0] != 0);
+    } else if (strcmp(op, "fill") == 0) {
+        if (sscanf(line, "%d %d %d %d %15s", &v[0], &v[1], &v[2], &v[3], a) != 5 || !color(a, &c))
+            return 0;
+        GLCD_FillRect(v[0], v[1], v[2], v[3], c);
+    } else if (strcmp(op, "invert") == 0) {
+        if (sscanf(line, "%d %d %d %d", &v[0], &v[1], &v[2], &v[3]) != 4)
+            return 0;
+        GLCD_InvertRect(v[0], v[1], v[2], v[3]);
+    } else if (strcmp(op, "line") == 0) {
+        if (sscanf(line, "%d %d %d %d %15s", &v[0], &v[1], &v[2], &v[3], a) != 5 || !color(a, &c))
+            return 0;
+        GLCD_DrawLine(v[0], v[1], v[2], v[3], c);
+    } else if (strcmp(op, "rect") == 0) {
+        if (sscanf(line, "%d %d %d %d %15s", &v[0], &v[1], &v[2], &v[3], a) != 5 || !color(a, &c))
+            return 0;
+        GLCD_DrawRect(v[0], v[1], v[2], v[3], c);
+    } else if (strcmp(op, "roundrect") == 0) {
+        if (sscanf(line, "%d %d %d %d %d %15s", &v[0], &v[1], &v[2], &v[3], &v[4], a) != 6 || !color(a, &c))
+            return 0;
+        GLCD_DrawRoundRect(v[0], v[1], v[2], v[3], v[4], c);
+    } else if (strcmp(op, "dot") == 0) {
+        if (sscanf(line, "%d %d %15s", &v[0], &v[1], a) != 3 || !color(a, &c))
+            return 0;
+        GLCD_SetDot(v[0], v[1], c);
+    } else if (strcmp(op, "bitmap") == 0) {
+        if (sscanf(line, "%d %d %15s", &v[0], &v[1], a) != 3 || !color(a, &c))
+            return 0;
+        GLCD_DrawBitmap(bitmap, v[0], v[1], c);
+    } else if (strcmp(op, "stream") == 0) {
+        if (sscanf(line, "%15s %d %d %15s", b, &v[0], &v[1], a) != 4 || !color(a, &c))
+            return 0;
+        if (strcmp(b, "memory") == 0) {
+            MemorySource m = { bitmap, 0 };
+
+            GLCD_DrawBitmapStream(readMemory, &m, v[0], v[1], c);
+        } else if (strcmp(b, "file") == 0) {
+            FILE *f = tmpfile();
+
+            if (!f || fwrite(bitmap, 1, sizeof (bitmap), f) != sizeof (bitmap)) {
+                perror("stream");
+                exit(2);
+            }
+            rewind(f);
+            GLCD_DrawBitmapStream(readFile, f, v[0], v[1], c);
+            fclose(f);
+        } else {
+            return 0;
+        }
+    } else if (strcmp(op, "font") == 0) {
+        n = sscanf(line, "%15s %15s", a, b);
+        if (n < 1 || (n == 2 && !color(b, &c)))
+            return 0;
+        if (strcmp(a, "system") == 0)
+            GLCD_SelectFontEx(System5x7, c, ReadPgmData);
+        else if (strcmp(a, "arial") == 0)
+            GLCD_SelectFontEx(Arial_14, c, ReadPgmData);
+        else if (strcmp(a, "latin") == 0)
+            GLCD_SelectFontEx(System5x7Latin, c, ReadPgmData);
+        else
+            return 0;
+    } else if (strcmp(op, "copy") == 0) {
+        if (sscanf(line, "%d %d %d %d %d %d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]) != 6)
+            return 0;
+        GLCD_CopyRect(v[0], v[1], v[2], v[3], v[4], v[5]);
+    } else if (strcmp(op, "scroll") == 0) {
+        if (sscanf(line, "%d %d %d %d %d %d %15s", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], a) != 7
+                || !color(a, &c))
+            return 0;
+        GLCD_ScrollRect(v[0], v[1], v[2], v[3], v[4], v[5], c);
+    } else if (strcmp(op, "polyline") == 0) {
+        lcdPoint points[16];
+
+        if (sscanf(line, "%15s%n", a, &n) != 1 || !color(a, &c))
+            return 0;
+        if ((n = values(line + n, 0, v, 32) / 2) == 0)
+            return 0;
+        for (i = 0; i < n; i++) {
+            points[i].x = v[2 * i];
+            points[i].y = v[2 * i + 1];
+        }
+        GLCD_DrawPolyline(points, n, c);
+    } else if (strcmp(op, "plot") == 0) {
+        uint8_t samples[DISPLAY_WIDTH];
+
+        if (sscanf(line, "%d %d %d %15s", &v[0], &v[1], &n, a) != 4 || !color(a, &c)
+                || n > DISPLAY_WIDTH)
+            return 0;
+        for (i = 0; i < n; i++)
+            samples[i] = wave(i) * 255 / 100;
+        GLCD_PlotSamples(v[0], samples, n, v[1], c);
+    } else if (strcmp(op, "gray") == 0) {
+        uint8_t gray[DISPLAY_WIDTH], band[DISPLAY_WIDTH];
+        int16_t error[DISPLAY_WIDTH + 1];
+        lcdDither dither;
+        int x, y;
+
+        if (sscanf(line, "%d %d %d %d %15s", &v[0], &v[1], &v[2], &v[3], a) != 5
+                || v[2] > DISPLAY_WIDTH || v[2] < 2)
+            return 0;
+        if (strcmp(a, "bayer") != 0 && strcmp(a, "floyd") != 0)
+            return 0;
+        GLCD_DitherInit(&dither, v[0], v[1], v[2], band, strcmp(a, "floyd") == 0 ? error : NULL);
+        for (y = 0; y < v[3]; y++) {
+            for (x = 0; x < v[2]; x++)
+                gray[x] = grayPixel(x, y, v[2], v[3]);
+            GLCD_DitherRow(&dither, gray);
+        }
+        GLCD_DitherEnd(&dither);
+    } else if (strcmp(op, "bar") == 0) {
+        lcdBar bar;
+
+        if (!(n = values(line, 5, v, 32)))
+            return 0;
+        GLCD_BarInit(&bar, v[0], v[1], v[2], v[3], v[4]);
+        for (i = 0; i < n; i++)
+            GLCD_BarSet(&bar, v[5 + i], 100);
+    } else if (strcmp(op, "level") == 0) {
+        lcdLevel level;
+
+        if (!(n = values(line, 6, v, 32)))
+            return 0;
+        GLCD_LevelInit(&level, v[0], v[1], v[2], v[3], v[4], v[5]);
+        for (i = 0; i < n; i++)
+            GLCD_LevelSet(&level, v[6 + i], 100);
+    } else if (strcmp(op, "gauge") == 0) {
+        lcdGauge gauge;
+
+        if (!(n = values(line, 3, v, 32)))
+            return 0;
+        GLCD_GaugeInit(&gauge, v[0], v[1], v[2]);
+        for (i = 0; i < n; i++)
+            GLCD_GaugeSet(&gauge, v[3 + i], 100);
+    } else if (strcmp(op, "chart") == 0) {
+        static uint8_t ring[2 * DISPLAY_WIDTH];
+        lcdChart chart;
+
+        if (sscanf(line, "%d %d %d %d %d %d %d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &n) != 7)
+            return 0;
+        GLCD_ChartInit(&chart, v[0], v[1], v[2], v[3], ring, v[4], v[5]);
+        for (i = 0; i < n; i++)
+            GLCD_ChartAdd(&chart, wave(i), 100);
+    } else if (strcmp(op, "textbox") == 0) {
+        char *text;
+
+        if (sscanf(line, "%d %d %d %d %d %n", &v[0], &v[1], &v[2], &v[3], &v[4], &n) != 5)
+            return 0;
+        for (text = line + n; *text; text++)
+            if (*text == '|')
+                *text = '\n';
+        GLCD_TextBox(v[0], v[1], v[2], v[3], line + n, v[4]);
+    } else if (strcmp(op, "bignum") == 0) {
+        lcdBigNum num;
+
+        if (!(n = values(line, 6, v, 32)))
+            return 0;
+        GLCD_BigNumInit(&num, v[0], v[1], v[2], v[3], v[4], v[5]);
+        for (i = 0; i < n; i++)
+            GLCD_BigNumSet(&num, v[6 + i]);
+    } else if (strcmp(op, "rotate") == 0) {
+        if (sscanf(line, "%d", &v[0]) != 1 || (v[0] != 0 && v[0] != 90 && v[0] != 270))
+            return 0;
+        GLCD_SetRotation(v[0] / 90);
+    } else if (strcmp(op, "goto") == 0) {
+        if (sscanf(line, "%d %d", &v[0], &v[1]) != 2)
+            return 0;
+        GLCD_GotoXY(v[0], v[1]);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+static int render(const char *path)
+{
+    char line[MAX_LINE];
+    unsigned number = 0;
+    FILE *f;
+
+    f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return 0;
+    }
+    GLCD_HostPowerOn();
+    GLCD_Init(NON_INVERTED);
+    GLCD_SetRotation(GLCD_ROTATE_0);
+    GLCD_SelectFont(System5x7);
+    current.count = 0;
+    GLCD_HostTrace(record);
+    while (fgets(line, sizeof (line), f)) {
+        number++;
+        line[strcspn(line, "\r\n")] = 0;
+        if (!command(line)) {
+            printf("%s:%u: can't parse \"%s\"\n", path, number, line);
+            fclose(f);
+            GLCD_HostTrace(NULL);
+            return 0;
+        }
+    }
+#ifdef GLCD_FRAMEBUFFER
+    GLCD_Flush();
+#endif
+    GLCD_HostTrace(NULL);
+    fclose(f);
+    return 1;
+}
+
+static void goldenPath(char *buf, const char *scene)
+{
+    const char *dot = strrchr(scene, '.');
+    int n = dot ? (int) (dot - scene) : (int) strlen(scene);
+
+    snprintf(buf, MAX_PATH, "%.*s.pbm", n, scene);
+}
+
+/* Plain PBM, one text row per display row so golden image changes diff well */
+static int writeGolden(const char *path)
+{
+    uint16_t x;
+    uint8_t y;
+    FILE *f;
+
+    f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return 0;
+    }
+    fprintf(f, "P1\n%u %u\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    for (y = 0; y < DISPLAY_HEIGHT; y++) {
+        for (x = 0; x < DISPLAY_WIDTH; x++)
+            fputc('0' + GLCD_HostPixel(x, y), f);
+        fputc('\n', f);
+    }
+    fclose(f);
+    return 1;
+}
+
+/* Returns the number of pixels that differ from the golden image, -1 if it can't be read */
+static long compareGolden(const char *path)
+{
+    unsigned width, height;
+    long diff = 0;
+    uint16_t x = 0;
+    uint8_t y = 0;
+    FILE *f;
+    int ch;
+
+    f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    if (fscanf(f, "P1 %u %u", &width, &height) != 2 || width != DISPLAY_WIDTH || height != DISPLAY_HEIGHT) {
+        printf("%s: not a %ux%u plain PBM\n", path, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        fclose(f);
+        return -1;
+    }
+    while (y < DISPLAY_HEIGHT && (ch = fgetc(f)) != EOF) {
+        if (ch != '0' && ch != '1')
+            continue;
+        if (ch - '0' != GLCD_HostPixel(x, y))
+            diff++;
+        if (++x == DISPLAY_WIDTH) {
+            x = 0;
+            y++;
+        }
+    }
+    fclose(f);
+    return y == DISPLAY_HEIGHT ? diff : -1;
+}
+
+static void writeTrace(FILE *f, const char *scene)
+{
+    size_t i;
+
+    fprintf(f, "scene %s %lu\n", scene, (unsigned long) current.count);
+    for (i = 0; i < current.count; i++)
+        fprintf(f, "%u %c %02X\n", current.log[i].chip, current.log[i].kind, current.log[i].value);
+}
+
+/* Reads the trace of scene from a recording into ref */
+static int readTrace(const char *path, const char *scene, Trace *ref)
+{
+    char line[MAX_LINE], name[MAX_PATH];
+    unsigned long count, i;
+    unsigned chip, value;
+    char kind;
+    FILE *f;
+
+    f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return 0;
+    }
+    while (fgets(line, sizeof (line), f)) {
+        if (sscanf(line, "scene %511s %lu", name, &count) != 2 || strcmp(name, scene) != 0)
+            continue;
+        ref->log = realloc(ref->log, (count + 1) * sizeof (Access));
+        for (i = 0; i < count && fgets(line, sizeof (line), f); i++) {
+            if (sscanf(line, "%u %c %x", &chip, &kind, &value) != 3)
+                break;
+            ref->log[i].chip = chip;
+            ref->log[i].kind = kind;
+            ref->log[i].value = value;
+        }
+        ref->count = i;
+        fclose(f);
+        return i == count;
+    }
+    fclose(f);
+    return 0;
+}
+
+static void countKinds(const Trace *t, unsigned long *n)
+{
+    size_t i;
+
+    memset(n, 0, 4 * sizeof (n[0]));
+    for (i = 0; i < t->count; i++)
+        n[strchr("CWRS", t->log[i].kind) - "CWRS"]++;
+}
+
+/* Next transaction from i on that isn't a status read */
+static size_t nextAccess(const Trace *t, size_t i)
+{
+    while (i < t->count && t->log[i].kind == 'S')
+        i++;
+    return i;
+}
+
+static void diffTrace(const char *path, const char *scene)
+{
+    static Trace ref;
+    unsigned long before[4], after[4];
+    size_t i, j, k;
+
+    if (!readTrace(path, scene, &ref)) {
+        printf("  no trace of %s in %s\n", scene, path);
+        return;
+    }
+    countKinds(&ref, before);
+    countKinds(&current, after);
+    printf("  commands %lu -> %lu, writes %lu -> %lu, reads %lu -> %lu, polls %lu -> %lu\n",
+            before[0], after[0], before[1], after[1], before[2], after[2], before[3], after[3]);
+
+    for (i = j = k = 0;; i++, j++, k++) {
+        i = nextAccess(&ref, i);
+        j = nextAccess(&current, j);
+        if (i == ref.count || j == current.count)
+            break;
+        if (ref.log[i].chip != current.log[j].chip || ref.log[i].kind != current.log[j].kind
+                || ref.log[i].value != current.log[j].value)
+            break;
+    }
+    if (i == ref.count && j == current.count)
+        printf("  same transactions\n");
+    else
+        printf("  transactions differ from #%lu on\n", (unsigned long) k);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-u] [-r trace] [-d trace] scene...\n", prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *recordPath = NULL, *diffPath = NULL;
+    char golden[MAX_PATH];
+    FILE *traceOut = NULL;
+    int i, update = 0, failed = 0;
+    long diff;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-u") == 0)
+            update = 1;
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+            diffPath = argv[++i];
+        else
+            usage(argv[0]);
+    }
+    if (i == argc)
+        usage(argv[0]);
+
+    bitmapInit();
+    if (recordPath) {
+        traceOut = fopen(recordPath, "w");
+        if (!traceOut) {
+            perror(recordPath);
+            return 2;
+        }
+    }
+
+    for (; i < argc; i++) {
+        const char *scene = argv[i];
+
+        if (!render(scene)) {
+            failed = 1;
+            continue;
+        }
+        goldenPath(golden, scene);
+        if (update) {
+            if (!writeGolden(golden))
+                failed = 1;
+            printf("%-40s written\n", golden);
+        } else {
+            diff = compareGolden(golden);
+            if (diff == 0) {
+                printf("%-40s ok\n", scene);
+            } else {
+                if (diff > 0)
+                    printf("%-40s FAIL, %ld pixels differ\n", scene, diff);
+                failed = 1;
+            }
+        }
+        if (traceOut)
+            writeTrace(traceOut, scene);
+        if (diffPath)
+            diffTrace(diffPath, scene);
+    }
+    if (traceOut)
+        fclose(traceOut);
+    return failed;
+}
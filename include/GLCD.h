@@ -14,38 +14,159 @@
 #ifndef	GLCD_H
 #define GLCD_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef uint8_t boolean;
 typedef uint8_t byte;
 
 #define GLCD_VERSION 2 // software version of this library
 
-// Chip specific includes
-#include "GLCD_Pins.h"
-
+/*
+ * Panel geometry, override with -D for other panels, e.g. DISPLAY_WIDTH=192
+ * for three controllers. Up to 4 chips and 256 columns are supported.
+ */
+#ifndef DISPLAY_WIDTH
 #define DISPLAY_WIDTH 128
+#endif
+#ifndef DISPLAY_HEIGHT
 #define DISPLAY_HEIGHT 64
+#endif
+#define DISPLAY_PAGES (DISPLAY_HEIGHT / 8)
 
 // panel controller chips
+#ifndef CHIP_WIDTH
 #define CHIP_WIDTH     64  // pixels per chip
+#endif
+#define GLCD_CHIP_COUNT (DISPLAY_WIDTH / CHIP_WIDTH)
+
+/*
+ * Uncomment to keep the display state (cursor, font, inversion, frame
+ * buffers) in lcdContext structures instead of a single static one, so one
+ * firmware can drive several panels, or a host program render independent
+ * displays from separate threads. GLCD_Use() selects the context the other
+ * functions work on, a built-in one until it is called. Left commented out,
+ * the state is addressed directly as before, at no extra cost.
+ *
+ * GLCD_PANELS panels can share the data and control lines, each with its own
+ * chip selects: lcdContext.panel n uses the chip select lines (or decoder
+ * outputs) n * GLCD_CHIP_COUNT and up. Panels share geometry and RST.
+ * GLCD_Service() works on the current context too, so a context switch must
+ * be done with the service interrupt locked out; GLCD_ServiceAll() services
+ * a list of contexts and leaves the current one as it found it.
+ *
+ * On the host the current context, the built-in one and the emulated panel
+ * are all thread local: a thread that never calls GLCD_Use() draws on its
+ * own built-in context and panel.
+ */
+// #define GLCD_CONTEXTS
+#ifndef GLCD_PANELS
+#define GLCD_PANELS 1
+#endif
+#define GLCD_CS_LINES (GLCD_CHIP_COUNT * GLCD_PANELS)
+
+#if GLCD_CS_LINES > 4 || DISPLAY_WIDTH > 256
+#error "Up to 4 chips and 256 columns are supported."
+#endif
+#if GLCD_PANELS > 1 && !defined(GLCD_CONTEXTS)
+#error "GLCD_PANELS needs GLCD_CONTEXTS."
+#endif
+
+/*
+ * Chip selection. By default each chip has its own CSELn line (GLCD_Pins.h),
+ * driven to GLCD_CS_ACTIVE for the selected chip and the opposite level for
+ * the others. Define GLCD_CS_DECODER when the chip selects come from a
+ * 2-to-4 decoder (e.g. 74HC139) addressed by CSA0 and CSA1.
+ */
+// #define GLCD_CS_DECODER
+#ifndef GLCD_CS_ACTIVE
+#define GLCD_CS_ACTIVE 0
+#endif
+
+/*
+ * Bus backend. By default the panel is on an 8 bit port with its control
+ * lines on port pins. Define GLCD_BUS_SPI for a panel behind two chained
+ * 74HC595 on the MSSP SPI port, a control register holding the chip selects
+ * (or decoder address) on Q0..Q3 and the GLCD_SPI_xx bits below, and a data
+ * register that drives the panel data lines, read back through a 74HC165.
+ * The other lines (EN, latch, load, data output enable) are in GLCD_Pins.h.
+ * Host builds can define GLCD_BUS_MEMORY to access the emulated controllers
+ * directly, without the pin level protocol.
+ */
+// #define GLCD_BUS_SPI
+// #define GLCD_BUS_MEMORY
+#define GLCD_SPI_DI     0x10
+#define GLCD_SPI_RW     0x20
+#define GLCD_SPI_RST    0x40
+
+#if defined(GLCD_BUS_MEMORY) && !defined(GLCD_HOST)
+#error "GLCD_BUS_MEMORY is only available in host builds"
+#endif
+
+// Chip specific includes
+#include "GLCD_Pins.h"
+
+#ifndef GLCD_TLS
+#define GLCD_TLS    // storage class of the current context, thread local on hosts
+#endif
+
+#ifndef GLCD_PROFILE_TIMER
+#define GLCD_PROFILE_TIMER()    GLCD_TIMER()
+#define GLCD_PROFILE_TICK       uint16_t
+#endif
 
 #define lcdDataOut(d)   GLCD_DOUT_REG = d
 #define lcdDataDir(d)   GLCD_DDIR_REG = d
 
 // Commands
-#ifdef HD44102 
-#define LCD_ON			0x39
-#define LCD_OFF			0x38
-#define LCD_DISP_START		0x3E   // Display start page 0
-#else
+#ifdef HD44102
+#error "the HD44102 is not supported, its addressing, commands and bus timing differ from the ks0108"
+#endif
 #define LCD_ON			0x3F
 #define LCD_OFF			0x3E
 #define LCD_DISP_START		0xC0
+
+/*
+ * Bus timing in ns, from the ks0108 datasheet, turned into delay cycles for
+ * _XTAL_FREQ below.
+ */
+#define GLCD_T_AS		140	// address setup before EN rises
+#define GLCD_T_PWEH		450	// EN high width
+#define GLCD_T_PWEL		450	// EN low width
+#define GLCD_T_DSW		200	// data setup before EN falls
+#define GLCD_T_DH		10	// data hold after EN falls
+#define GLCD_T_DDR		320	// read data valid after EN rises
+#define GLCD_T_CYC		1000	// enable cycle
+
+/*
+ * The timing above in instruction cycles at _XTAL_FREQ, rounded up at compile
+ * time, for the bus code of GLCD.c and Glcd.hpp. Anything longer, like the
+ * time a chip needs to process a byte, is left to the busy flag poll.
+ */
+#define GLCD_NS_TO_CYCLES(ns) (((ns) * (_XTAL_FREQ / 4000UL) + 999999UL) / 1000000UL)
+#define GLCD_DELAY_NS(ns)                                   \
+    do {                                                    \
+        if (GLCD_NS_TO_CYCLES(ns) > 0)                      \
+            _delay(GLCD_NS_TO_CYCLES(ns));                  \
+    } while (0)
+
+#define GLCD_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+#define SETUP_DELAY() GLCD_DELAY_NS(GLCD_T_AS) // D/I and R/W setup before EN rises
+#define EN_DELAY() GLCD_DELAY_NS(GLCD_MAX(GLCD_T_PWEH, GLCD_MAX(GLCD_T_DSW, GLCD_T_DDR))) // EN high
+#define EN_LOW_DELAY() GLCD_DELAY_NS(GLCD_MAX(GLCD_T_PWEL, GLCD_MAX(GLCD_T_DH, GLCD_T_CYC - GLCD_T_PWEH))) // EN low
+#define RST_DELAY() __delay_us(2) // reset pulse width, min 1 us
+
+#ifndef GLCD_T_BUSY
+#define GLCD_T_BUSY		3000	// busy time after an access, 3/fCLK at 1 MHz, depends on the module
 #endif
 
 #define LCD_SET_ADD		0x40
 #define LCD_SET_PAGE		0xB8
 
 #define LCD_BUSY_FLAG		0x80 
+#define LCD_RESET_FLAG		0x10
 
 // Colors
 #define BLACK			0xFF
@@ -55,6 +176,19 @@ typedef uint8_t byte;
 #define NON_INVERTED 0
 #define INVERTED     1
 
+/*
+ * Orientations for GLCD_SetRotation(). Rotated by 90 or 270 degrees the
+ * coordinates of all drawing and text functions are those of the panel
+ * turned on its side: DISPLAY_HEIGHT wide and DISPLAY_WIDTH tall, with text
+ * and bitmaps upright in it. GLCD_ROTATE_90 turns the picture clockwise,
+ * so its top is at the panel's right edge. GLCD_ClearPage(), GLCD_WritePage()
+ * and the page based strip chart, dithering and gray layer keep addressing
+ * panel pages.
+ */
+#define GLCD_ROTATE_0   0
+#define GLCD_ROTATE_90  1
+#define GLCD_ROTATE_270 3
+
 // Font Indices
 #define FONT_LENGTH		0
 #define FONT_FIXED_WIDTH	2
@@ -63,18 +197,215 @@ typedef uint8_t byte;
 #define FONT_CHAR_COUNT		5
 #define FONT_WIDTH_TABLE	6
 
+/*
+ * Range fonts have a FONT_CHAR_COUNT of 0. Their glyphs are listed by
+ * ranges of consecutive codes up to U+FFFF, sorted by first code, so a few
+ * extra glyphs cost no flash for the codes between them. Each range gives
+ * the number of its first glyph in the width table and the data column of
+ * that glyph. FONT_FIXED_WIDTH is the width of all glyphs, or 0 when there
+ * is a width table. Glyph data is laid out like that of fixed width fonts.
+ * 16 bit fields are high byte first. See SystemFont5x7Latin.h.
+ */
+#define FONT_RANGE_COUNT	6
+#define FONT_GLYPH_COUNT	7	// 2 bytes
+#define FONT_FALLBACK		9	// 2 bytes, code of the glyph drawn for codes the font lacks
+#define FONT_RANGES		11	// first code (2 bytes), count, first glyph (2), first column (2)
+#define FONT_RANGE_SIZE		7
+
+// GLCD_TextBox() flags
+#define GLCD_ALIGN_LEFT		0x00
+#define GLCD_ALIGN_CENTER	0x01
+#define GLCD_ALIGN_RIGHT	0x02
+#define GLCD_TEXT_WRAP		0x04	// break lines between words
+#define GLCD_TEXT_ELLIPSIS	0x08	// end a cut line, or the last line when text is left, with "..."
+#define GLCD_TEXT_UTF8		0x10	// the text is UTF-8
+
 
 // Uncomment for slow drawing
 // #define DEBUG
 
+/*
+ * Uncomment to skip the busy flag poll when GLCD_T_BUSY has already passed
+ * since the last access to a chip, as measured by GLCD_TIMER() (GLCD_Pins.h).
+ * The poll is still done for accesses that come sooner. Leave it commented
+ * out to always poll, e.g. to rule out a wrong GLCD_T_BUSY while debugging.
+ */
+// #define GLCD_BUSY_ELISION
+
+/*
+ * Uncomment to draw into a RAM copy of the display (DISPLAY_WIDTH * DISPLAY_PAGES
+ * bytes) instead of the panel. Drawing functions then return without touching
+ * the bus, and GLCD_Service() sends the changed columns to the panel a few
+ * bytes per call, from the main loop or a timer interrupt.
+ */
+// #define GLCD_FRAMEBUFFER
+
+/*
+ * Uncomment (with GLCD_FRAMEBUFFER) to keep a second RAM copy holding what
+ * was last sent to the panel. Only the bytes that differ from it are sent,
+ * which suits gauges and animations where most of a frame stays the same.
+ * Needs another DISPLAY_WIDTH * DISPLAY_PAGES bytes of RAM.
+ */
+// #define GLCD_DOUBLE_BUFFER
+
+/*
+ * Longest run of unchanged columns rewritten between two changed ones
+ * instead of moving the column address with LCD_SET_ADD. A command costs
+ * the same bus time as a data byte on this bus, so a gap of one column is
+ * the break-even point; raise it if a command is slower on your panel, as
+ * reported by GLCD_GetFrameStats().
+ */
+#ifndef GLCD_DIFF_GAP
+#define GLCD_DIFF_GAP 1
+#endif
+
+/*
+ * Bus transfers done by one GLCD_Service() call. Each transfer is a status
+ * read followed by one command or data write, and the call returns early as
+ * soon as a chip reports busy, so it never spins.
+ * With the ks0108 timing a transfer takes about 3.4 us at 64 MHz, so the worst
+ * case for a call is about GLCD_SERVICE_BUDGET * 3.4 us (54 us measured in the
+ * host emulator with the default of 16, 104 us at 16 MHz). GLCD_HostTime() around the call
+ * gives the exact figure for a build; the Service/budget entry of
+ * bench/GlcdPrimitives.c measures one call on a fully dirty frame and is kept
+ * in the framebuffer section of bench/baseline.txt.
+ */
+#ifndef GLCD_SERVICE_BUDGET
+#define GLCD_SERVICE_BUDGET 16
+#endif
+
+/*
+ * If GLCD_Service() is called from an interrupt, define these to disable and
+ * re-enable that interrupt (e.g. di() and ei()). They guard the dirty column
+ * bookkeeping shared by the drawing functions and the service routine.
+ */
+#ifndef GLCD_SERVICE_LOCK
+#define GLCD_SERVICE_LOCK()
+#define GLCD_SERVICE_UNLOCK()
+#endif
+
+/*
+ * Uncomment to time the drawing functions with GLCD_PROFILE_TIMER(), the
+ * GLCD_TIMER() of GLCD_Pins.h unless defined otherwise. Each function keeps
+ * its number of calls and the total, shortest and longest call in timer
+ * ticks, the functions it calls included. GLCD_ProfileDump() prints the
+ * table through a putc function (e.g. the UART's) and GLCD_ProfileReset()
+ * clears it. Left commented out, both calls compile to nothing.
+ * A 16 bit timer wraps after 65536 ticks, 4 ms at 64 MHz with Timer1 on
+ * Fosc/4: for longer calls use a prescaler, or a 32 bit count with
+ * GLCD_PROFILE_TICK defined as uint32_t.
+ */
+// #define GLCD_PROFILE
+
 typedef struct {
+#if DISPLAY_WIDTH > 255
+	uint16_t x;	// can step past column 255
+#else
 	uint8_t x;
+#endif
 	uint8_t y;
 	uint8_t page;
 } lcdCoord;
 
+/* Polyline vertex, see GLCD_DrawPolyline() */
+typedef struct {
+	uint8_t x;
+	uint8_t y;
+} lcdPoint;
+
+/* Bus traffic of a frame sent by GLCD_Service() */
+typedef struct {
+	uint16_t bytes;
+	uint16_t commands;
+} lcdFrameStats;
+
 typedef uint8_t (*FontCallback)(const uint8_t*);
 
+/*
+ * Source of GLCD_DrawBitmapStream(): fills buf with the next n bytes of the
+ * bitmap (n is at most GLCD_STREAM_CHUNK, or 8 while rotated) and returns how many it got.
+ * Fewer than n ends the drawing, e.g. on a read error.
+ */
+typedef uint8_t (*BitmapCallback)(void *source, uint8_t *buf, uint8_t n);
+
+// Largest request of a BitmapCallback, the size of the stream's RAM buffer
+#ifndef GLCD_STREAM_CHUNK
+#define GLCD_STREAM_CHUNK 16
+#endif
+
+/* Frame buffer output engine position, see GLCD_Service() */
+typedef struct {
+	uint8_t page;
+	uint8_t pending;	/* chips with columns of the run left to send */
+	uint8_t turn;	/* chip that sent the last byte */
+	uint8_t x[GLCD_CHIP_COUNT];	/* next column to send on each chip */
+	uint8_t last[GLCD_CHIP_COUNT];	/* last column of the run on each chip */
+	uint8_t chipPage[GLCD_CHIP_COUNT];	/* page and column registers of each chip */
+	uint8_t chipCol[GLCD_CHIP_COUNT];
+	lcdFrameStats count;	/* bus traffic of the frame being sent */
+} lcdFrameOut;
+
+/* State of one display, see GLCD_CONTEXTS. Zero it and set panel before GLCD_Init(). */
+typedef struct {
+	uint8_t panel;	/* chip select group of the panel on the bus */
+	uint8_t off;	/* chips GLCD_Init() left in reset, never waited for */
+	lcdCoord coord;
+	uint8_t inverted;	/* 0x00 or 0xFF, XORed into the color where data is written */
+	uint8_t fontColor;
+	const uint8_t *font;
+	FontCallback fontRead;
+	uint8_t rotation;	/* GLCD_ROTATE_xx */
+	lcdPoint cursor;	/* text position while rotated, in rotated coordinates */
+#ifdef GLCD_BUSY_ELISION
+	uint16_t readyAt[GLCD_CHIP_COUNT];	/* GLCD_TIMER() value when each chip is ready */
+#endif
+#ifdef GLCD_FRAMEBUFFER
+	uint8_t frame[DISPLAY_PAGES][DISPLAY_WIDTH];
+	uint8_t dirtyLo[DISPLAY_PAGES];	/* changed columns of each page, none if Lo > Hi */
+	uint8_t dirtyHi[DISPLAY_PAGES];
+#ifdef GLCD_DOUBLE_BUFFER
+	uint8_t shown[DISPLAY_PAGES][DISPLAY_WIDTH];	/* what the panel holds */
+#endif
+	lcdFrameOut out;
+	lcdFrameStats lastFrame;
+#endif
+} lcdContext;
+
+#ifdef GLCD_PROFILE
+// Profiled functions, GLCD_ProfileGet() index
+enum {
+	GLCD_PROF_INIT,
+	GLCD_PROF_CLEAR_SCREEN,
+	GLCD_PROF_DRAW_LINE,
+	GLCD_PROF_DRAW_RECT,
+	GLCD_PROF_DRAW_ROUND_RECT,
+	GLCD_PROF_FILL_RECT,
+	GLCD_PROF_INVERT_RECT,
+	GLCD_PROF_SET_INVERTED,
+	GLCD_PROF_SET_DOT,
+	GLCD_PROF_DRAW_BITMAP,
+	GLCD_PROF_PUT_CHAR,
+	GLCD_PROF_PUTS,
+	GLCD_PROF_SERVICE,
+	GLCD_PROF_FLUSH,
+	GLCD_PROF_DRAW_POLYLINE,
+	GLCD_PROF_PLOT_SAMPLES,
+	GLCD_PROF_COPY_RECT,
+	GLCD_PROF_SCROLL_RECT,
+	GLCD_PROF_DRAW_BITMAP_STREAM,
+	GLCD_PROF_TEXT_BOX,
+	GLCD_PROF_PUTS_UTF8,
+	GLCD_PROF_COUNT
+};
+
+typedef struct {
+	uint32_t calls;
+	uint32_t total;		// ticks
+	GLCD_PROFILE_TICK min;
+	GLCD_PROFILE_TICK max;
+} lcdProfile;
+#endif
+
 uint8_t ReadPgmData(const uint8_t* ptr);	//Standard Read Callback
 
 #define GLCD_DrawVertLine(x, y, length, color) GLCD_FillRect(x, y, 0, length, color)
@@ -85,25 +416,57 @@ uint8_t ReadPgmData(const uint8_t* ptr);	//Standard Read Callback
 #define GLCD_SelectFont(font) GLCD_SelectFontEx(font, BLACK, ReadPgmData)
 
 // Control functions
-void GLCD_Init(boolean invert);
+uint8_t GLCD_Init(boolean invert); // chips that did not leave reset, one bit each, 0 when all are on
+#ifdef GLCD_CONTEXTS
+void GLCD_Use(lcdContext *ctx); // the calls that follow work on ctx, NULL for the built-in context
+#endif
 void GLCD_GotoXY(uint8_t x, uint8_t y);
+void GLCD_SetRotation(uint8_t rotation);
 
 // Graphic Functions
 void GLCD_ClearPage(uint8_t page, uint8_t color);
 void GLCD_ClearScreen(uint8_t color);
 void GLCD_DrawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t color);
+void GLCD_DrawPolyline(const lcdPoint *points, uint8_t n, uint8_t color);
+void GLCD_PlotSamples(uint8_t x0, const uint8_t *samples, uint8_t n, uint8_t yscale, uint8_t color);
 void GLCD_DrawRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color);
 void GLCD_DrawRoundRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t radius, uint8_t color);
 void GLCD_FillRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color);
 void GLCD_InvertRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+void GLCD_CopyRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t dstX, uint8_t dstY);
+void GLCD_ScrollRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, int8_t dx, int8_t dy, uint8_t color);
 void GLCD_SetInverted(boolean invert);
 void GLCD_SetDot(uint8_t x, uint8_t y, uint8_t color);
 void GLCD_DrawBitmap(const uint8_t *bitmap, uint8_t x, uint8_t y, uint8_t color);
+void GLCD_DrawBitmapStream(BitmapCallback read, void *source, uint8_t x, uint8_t y, uint8_t color);
+void GLCD_WritePage(uint8_t x, uint8_t page, const uint8_t *data, uint8_t count);
+
+#ifdef GLCD_FRAMEBUFFER
+// Output engine
+void GLCD_Service(void);
+boolean GLCD_FrameComplete(void);
+void GLCD_Flush(void); // calls GLCD_Service() until the frame is complete
+void GLCD_GetFrameStats(lcdFrameStats *stats); // traffic of the last completed frame
+#ifdef GLCD_CONTEXTS
+void GLCD_ServiceAll(lcdContext *const *ctx, uint8_t count); // GLCD_Service() on each context
+#endif
+#endif
+
+// Profiling
+#ifdef GLCD_PROFILE
+void GLCD_ProfileReset(void);
+void GLCD_ProfileDump(void (*out)(char c)); // one line per function: name calls total min max
+const lcdProfile *GLCD_ProfileGet(uint8_t id);
+#else
+#define GLCD_ProfileReset()
+#define GLCD_ProfileDump(out)
+#endif
 
 // Font Functions
 void GLCD_SelectFontEx(const uint8_t* font, uint8_t color, FontCallback callback);
 int  GLCD_PutChar(char c);
 void GLCD_Puts(const char *str);
+void GLCD_PutsUtf8(const char *str);
 void GLCD_PrintNumber(long n);
 void GLCD_PrintHexNumber(uint16_t n);
 void GLCD_PrintRealNumber(double n);
@@ -111,5 +474,11 @@ void GLCD_CursorTo( uint8_t x, uint8_t y); // 0 based coordinates for fixed widt
 
 uint8_t  GLCD_CharWidth(char c);
 uint16_t GLCD_StringWidth(const char *str);
+// Text in the box x to x + width, y to y + height, returns the text that didn't fit
+const char *GLCD_TextBox(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const char *str, uint8_t flags);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
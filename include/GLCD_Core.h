@@ -0,0 +1,2444 @@
+/*
+  GLCD_Core.h - drawing algorithms of the PIC GLCD library for ks0108 graphic LCDs
+
+  Not a header of its own. GLCD.c includes it after its bus backend, context
+  storage and profiling macros, and Glcd.hpp includes it in the body of the
+  Glcd class template with the bus, the geometry and the state bound to the
+  template parameters, so both draw with the same code. The includer defines
+
+    GLCD_SelectChip() .. GLCD_BusWrite()    bus primitives, see GLCD.c
+    GLCD_BUS_RUN and the bulk transfers     optional
+    GLCD_Ctx                                the lcdContext fields used below
+    GLCD_ChipOf(), GLCD_ChipCol(), GLCD_PastWidth(), _BV()
+    GLCD_PROFILE_ENTER(), GLCD_PROFILE_EXIT()
+
+  and may define GLCD_FontRead(p) with GLCD_SetFontReader(f) to read fonts
+  without the callback, and GLCD_API as the storage class of the functions
+  GLCD.h declares.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef GLCD_API
+#define GLCD_API
+#endif
+
+/* Status polls allowed for the chips to leave reset, about 100 ms with the default timing */
+#ifndef GLCD_INIT_TIMEOUT
+#define GLCD_INIT_TIMEOUT 25000
+#endif
+
+/* Bytes read back per burst when the whole screen is inverted */
+#ifndef GLCD_INVERT_CHUNK
+#define GLCD_INVERT_CHUNK 16
+#endif
+
+#define isFixedWidthFont(font)  (GLCD_FontRead(font+FONT_LENGTH) == 0 && GLCD_FontRead(font+FONT_LENGTH+1) == 0)
+#define isRangeFont(font)       (GLCD_FontRead(font+FONT_CHAR_COUNT) == 0)
+#define isThieleFont(font)      (!isFixedWidthFont(font) && !isRangeFont(font))
+
+/* A chip that never left reset stays busy, it is selected but not waited for */
+#define GLCD_PollReady(chip)                        \
+    do {                                            \
+        GLCD_SelectChip(chip);                      \
+        if (!(GLCD_Off & _BV(chip)))                \
+            GLCD_BusPoll();                         \
+    } while (0)
+
+#ifdef GLCD_BUSY_ELISION
+/*
+ * The time each chip becomes ready again is tracked with GLCD_TIMER(), so the
+ * busy flag is only read when an access comes sooner than that. The stamp is
+ * taken before the access, so the access itself is added to the busy time.
+ */
+#define GLCD_BUSY_TICKS ((GLCD_NS_TO_CYCLES(GLCD_T_BUSY + GLCD_T_AS + GLCD_T_PWEH) + 8) / GLCD_TIMER_PRESCALE + 1)
+#define GLCD_ChipIdle(chip) ((int16_t) ((uint16_t) GLCD_TIMER() - GLCD_ReadyAt[chip]) >= 0)
+#define GLCD_MarkBusy(chip) GLCD_ReadyAt[chip] = (uint16_t) GLCD_TIMER() + GLCD_BUSY_TICKS
+
+#define GLCD_WaitReady(chip)                        \
+    do {                                            \
+        if (GLCD_ChipIdle(chip))                    \
+            GLCD_SelectChip(chip);                  \
+        else                                        \
+            GLCD_PollReady(chip);                   \
+        GLCD_MarkBusy(chip);                        \
+    } while (0)
+#else
+#define GLCD_ChipIdle(chip) 0
+#define GLCD_MarkBusy(chip)
+#define GLCD_WaitReady(chip) GLCD_PollReady(chip)
+#endif
+
+#ifdef GLCD_FRAMEBUFFER
+#define GLCD_ReadData(data) data = GLCD_FrameRead()
+#else
+#define GLCD_ReadData(data)                             \
+    do {                                                \
+        GLCD_DoReadData(1); /* dummy read */            \
+        data = GLCD_DoReadData(0); /* "real" read */    \
+    } while (0)
+#endif
+
+#define GLCD_WriteCommand(cmd, chip)                    \
+    do {                                                \
+        GLCD_WaitReady(chip);                           \
+        GLCD_BusWrite(0, cmd);                          \
+    }  while (0)
+
+#define GLCD_Coord      GLCD_Ctx.coord
+#define GLCD_Inverted   GLCD_Ctx.inverted
+#define GLCD_FontColor  GLCD_Ctx.fontColor
+#define GLCD_Font       GLCD_Ctx.font
+#define GLCD_Rotation   GLCD_Ctx.rotation
+#define GLCD_Cursor     GLCD_Ctx.cursor
+#define GLCD_ReadyAt    GLCD_Ctx.readyAt
+#define GLCD_Off        GLCD_Ctx.off
+
+/* Font reader, a function pointer in the context unless the includer binds one */
+#ifndef GLCD_FontRead
+#define GLCD_FontRead   GLCD_Ctx.fontRead
+#define GLCD_SetFontReader(f) GLCD_FontRead = (f)
+#endif
+
+/* Text position, logical while rotated */
+#define GLCD_TextX() (GLCD_Rotation ? GLCD_Cursor.x : GLCD_Coord.x)
+#define GLCD_TextY() (GLCD_Rotation ? GLCD_Cursor.y : GLCD_Coord.y)
+
+#ifdef GLCD_FRAMEBUFFER
+#define GLCD_UNKNOWN 0xFF /* register content not known */
+
+#define GLCD_Frame      GLCD_Ctx.frame
+#define GLCD_DirtyLo    GLCD_Ctx.dirtyLo
+#define GLCD_DirtyHi    GLCD_Ctx.dirtyHi
+#define GLCD_Shown      GLCD_Ctx.shown
+#define GLCD_Out        GLCD_Ctx.out
+#define GLCD_LastFrame  GLCD_Ctx.lastFrame
+#endif
+
+#ifndef GLCD_CORE_CLASS
+static void GLCD_SetAddress(uint8_t x, uint8_t y);
+uint8_t GLCD_DoReadData(uint8_t first);
+static uint8_t GLCD_ReadNext(uint8_t chip);
+#ifdef GLCD_FRAMEBUFFER
+static uint8_t GLCD_FrameRead(void);
+static void GLCD_FramePut(uint8_t page, uint8_t x, uint8_t data);
+static void GLCD_FrameDirtyAll(void);
+#endif
+void GLCD_WriteData(uint8_t data); // experts can make this public but the functionality is not documented
+static void GLCD_WriteRun(uint8_t page, uint8_t x, uint8_t last, const uint8_t *data, uint8_t step);
+static void GLCD_ReadRun(uint8_t page, uint8_t x, uint8_t n, uint8_t *buf);
+#endif
+
+//#define GLCD_DEBUG  // uncomment this if you want to slow down drawing to see how pixels are set
+
+/*
+ * Rotation, see GLCD_SetRotation(). The drawing functions take logical
+ * coordinates; while rotated, the leaf functions clip a rectangle to the
+ * rotated screen and move it to the panel, where width and height trade
+ * places. Everything built on them follows without changes.
+ */
+#define GLCD_Width()  (GLCD_Rotation ? DISPLAY_HEIGHT : DISPLAY_WIDTH)
+#define GLCD_Height() (GLCD_Rotation ? DISPLAY_WIDTH : DISPLAY_HEIGHT)
+
+/*
+ * Merge of a GLCD_WriteData() byte that starts yOffset rows into a page,
+ * into the panel byte of that page (Low) and of the one below (High). The
+ * data comes in panel colors but is ORed in screen colors: while inverted
+ * its set pixels clear panel bits, else they would fill the whole page.
+ */
+#define GLCD_MergeLow(panel, data, yOffset) (GLCD_Inverted \
+        ? (uint8_t) ((panel) & ~((uint8_t) ~(data) << (yOffset))) \
+        : (uint8_t) ((panel) | (data) << (yOffset)))
+#define GLCD_MergeHigh(panel, data, yOffset) (GLCD_Inverted \
+        ? (uint8_t) ((panel) & ~((uint8_t) ~(data) >> (8 - (yOffset)))) \
+        : (uint8_t) ((panel) | (data) >> (8 - (yOffset))))
+
+/* Clips x to x + width and y to y + height to the rotated screen, 0 if outside */
+static uint8_t GLCD_ClipRect(uint8_t x, uint8_t y, uint8_t *width, uint8_t *height)
+{
+    if (x > DISPLAY_HEIGHT - 1 || GLCD_PastWidth(y))
+        return 0;
+    if (*width > DISPLAY_HEIGHT - 1 - x)
+        *width = DISPLAY_HEIGHT - 1 - x;
+    if (*height > DISPLAY_WIDTH - 1 - y)
+        *height = DISPLAY_WIDTH - 1 - y;
+    return 1;
+}
+
+/* Moves a clipped logical rectangle to the panel */
+static void GLCD_RotateRect(uint8_t *x, uint8_t *y, uint8_t *width, uint8_t *height)
+{
+    uint8_t u = *x, v = *y, w = *width;
+
+    if (GLCD_Rotation == GLCD_ROTATE_90) {
+        *x = DISPLAY_WIDTH - 1 - v - *height;
+        *y = u;
+    } else {
+        *x = v;
+        *y = DISPLAY_HEIGHT - 1 - u - w;
+    }
+    *width = *height;
+    *height = w;
+}
+
+static uint8_t GLCD_ToPanel(uint8_t *x, uint8_t *y, uint8_t *width, uint8_t *height)
+{
+    if (!GLCD_ClipRect(*x, *y, width, height))
+        return 0;
+    GLCD_RotateRect(x, y, width, height);
+    return 1;
+}
+
+/*
+ * Transposes an 8 x 8 block of column bytes, bit k of in[i] being row k of
+ * column i, in two 32 bit words (Hacker's Delight, transpose8). The result
+ * is the 8 panel columns the block lands on, left to right: for
+ * GLCD_ROTATE_90 out[m] is row 7 - m with bit i from column i, for
+ * GLCD_ROTATE_270 row m with bit i from column 7 - i.
+ */
+static void GLCD_Transpose(const uint8_t *in, uint8_t *out, uint8_t rotation)
+{
+    uint32_t x, y, t;
+
+    if (rotation == GLCD_ROTATE_90) {
+        x = (uint32_t) in[7] << 24 | (uint32_t) in[6] << 16 | (uint32_t) in[5] << 8 | in[4];
+        y = (uint32_t) in[3] << 24 | (uint32_t) in[2] << 16 | (uint32_t) in[1] << 8 | in[0];
+    } else {
+        x = (uint32_t) in[0] << 24 | (uint32_t) in[1] << 16 | (uint32_t) in[2] << 8 | in[3];
+        y = (uint32_t) in[4] << 24 | (uint32_t) in[5] << 16 | (uint32_t) in[6] << 8 | in[7];
+    }
+
+    t = (x ^ (x >> 7)) & 0x00AA00AAUL;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AAUL;
+    y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCCUL;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCCUL;
+    y = y ^ t ^ (t << 14);
+    t = (x & 0xF0F0F0F0UL) | ((y >> 4) & 0x0F0F0F0FUL);
+    y = ((x << 4) & 0xF0F0F0F0UL) | (y & 0x0F0F0F0FUL);
+    x = t;
+
+    if (rotation == GLCD_ROTATE_90) {
+        out[0] = x >> 24; out[1] = x >> 16; out[2] = x >> 8; out[3] = x;
+        out[4] = y >> 24; out[5] = y >> 16; out[6] = y >> 8; out[7] = y;
+    } else {
+        out[7] = x >> 24; out[6] = x >> 16; out[5] = x >> 8; out[4] = x;
+        out[3] = y >> 24; out[2] = y >> 16; out[1] = y >> 8; out[0] = y;
+    }
+}
+
+/*
+ * Writes n bytes to a page from column x on, only the rows top to bottom of
+ * it; the page is read first when they cover part of it.
+ */
+static void GLCD_MergePage(uint8_t x, int16_t page, const uint8_t *data, uint8_t n, int16_t top, int16_t bottom)
+{
+    uint8_t buf[8], mask, i;
+    int16_t first = top - page * 8, last = bottom - page * 8;
+
+    if (page < 0 || page > DISPLAY_PAGES - 1 || first > 7 || last < 0)
+        return;
+    mask = 0xFF;
+    if (first > 0)
+        mask <<= first;
+    if (last < 7)
+        mask &= 0xFF >> (7 - last);
+    if (mask != 0xFF) {
+        GLCD_ReadRun(page, x, n, buf);
+        for (i = 0; i < n; i++)
+            buf[i] = (buf[i] & ~mask) | (data[i] & mask);
+        data = buf;
+    }
+    GLCD_WriteRun(page, x, x + n - 1, data, 1);
+}
+
+/*
+ * Draws an image of width columns and height rows, in the bitmap layout of
+ * pages of column bytes, upright at logical x, y of the rotated screen. The
+ * cols x rows box from x, y is drawn, the part of it outside the image in
+ * the background. color is XORed into the data.
+ *
+ * The image is read from source 8 columns of a page at a time, in order, and
+ * each 8 x 8 block is transposed into the bytes of 8 panel columns. Logical
+ * rows become panel columns, so the blocks of a page of the image go down
+ * the same 8 panel columns; they are shifted together into page bytes, and
+ * every page byte of the box is written once, in sequential runs, and read
+ * only at the ends of the box.
+ */
+static void GLCD_DrawRotated(BitmapCallback read, void *source, uint8_t x, uint8_t y,
+        uint8_t width, uint8_t height, uint8_t cols, uint8_t rows, uint8_t color)
+{
+    uint8_t in[8], out[8], pend[8], buf[8];
+    uint8_t pages, blocks, j, b, i, n, k, shift, data;
+    int16_t top, bottom, row, page, col;
+
+    if (x > DISPLAY_HEIGHT - 1 || GLCD_PastWidth(y))
+        return;
+    if (cols > DISPLAY_HEIGHT - x)
+        cols = DISPLAY_HEIGHT - x;
+    if (rows > DISPLAY_WIDTH - y)
+        rows = DISPLAY_WIDTH - y;
+    pages = (height + 7) / 8;
+    blocks = ((width > cols ? width : cols) + 7) / 8;
+
+    /* panel rows of the box, and the panel row of bit 0 of the first block */
+    if (GLCD_Rotation == GLCD_ROTATE_90) {
+        top = x;
+        row = x;
+    } else {
+        top = DISPLAY_HEIGHT - x - cols;
+        row = DISPLAY_HEIGHT - 8 - x;
+    }
+    bottom = top + cols - 1;
+    shift = (uint8_t) row & 7;
+
+    for (j = 0; j * 8 < rows; j++) {
+        n = rows - j * 8 < 8 ? rows - j * 8 : 8;
+        if (GLCD_Rotation == GLCD_ROTATE_90)
+            col = DISPLAY_WIDTH - y - j * 8 - n;
+        else
+            col = y + j * 8;
+        page = -1;
+        for (i = 0; i < 8; i++)
+            pend[i] = 0;
+
+        for (b = 0; b < blocks; b++) {
+            k = 0;
+            if (j < pages && b * 8 < width) {
+                k = width - b * 8 < 8 ? width - b * 8 : 8;
+                if (read(source, in, k) != k)
+                    return;
+            }
+            if (b * 8 >= cols)
+                continue; /* read on, the rest of the source is off the screen */
+            for (i = 0; i < 8; i++)
+                in[i] = (i < k ? in[i] : 0) ^ color;
+            GLCD_Transpose(in, out, GLCD_Rotation);
+
+            /*
+             * The block's bytes straddle two pages unless shift is 0. The
+             * page shared with the previous block is completed and written,
+             * the other part waits in pend for the next block.
+             */
+            if (GLCD_Rotation == GLCD_ROTATE_90) {
+                page = (row + b * 8 - shift) / 8;
+                for (i = 0; i < n; i++) {
+                    data = out[8 - n + i];
+                    buf[i] = (data << shift) | pend[i];
+                    pend[i] = shift ? data >> (8 - shift) : 0;
+                }
+                GLCD_MergePage(col, page, buf, n, top, bottom);
+                page++;
+            } else {
+                page = (row - b * 8 - shift) / 8;
+                for (i = 0; i < n; i++) {
+                    data = out[i];
+                    buf[i] = (shift ? data >> (8 - shift) : 0) | pend[i];
+                    pend[i] = data << shift;
+                }
+                GLCD_MergePage(col, page + 1, buf, n, top, bottom);
+            }
+        }
+        GLCD_MergePage(col, page, pend, n, top, bottom);
+    }
+}
+
+/* BitmapCallback reading a bitmap in program memory, source points to the pointer */
+static uint8_t GLCD_PgmSource(void *source, uint8_t *buf, uint8_t n)
+{
+    const uint8_t **data = (const uint8_t **) source;
+    uint8_t i;
+
+    for (i = 0; i < n; i++)
+        buf[i] = ReadPgmData((*data)++);
+    return n;
+}
+
+GLCD_API void GLCD_ClearPage(uint8_t page, uint8_t color)
+{
+    color ^= GLCD_Inverted;
+    GLCD_WriteRun(page, 0, DISPLAY_WIDTH - 1, &color, 0);
+}
+
+GLCD_API void GLCD_ClearScreen(uint8_t color)
+{
+    uint8_t page;
+    GLCD_PROFILE_ENTER();
+    for (page = 0; page < DISPLAY_PAGES; page++) {
+        GLCD_ClearPage(page, color);
+    }
+    GLCD_PROFILE_EXIT(GLCD_PROF_CLEAR_SCREEN);
+}
+
+/*
+ * First, define a few macros to make the DrawLine code below read more like
+ * the wikipedia example code.
+ */
+
+#define _GLCD_absDiff(x,y) ((x>y) ?  (x-y) : (y-x))
+#define _GLCD_swap(a,b) \
+do\
+{\
+uint8_t t;\
+	t=a;\
+	a=b;\
+	b=t;\
+} while(0)
+
+GLCD_API void GLCD_DrawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t color)
+{
+    uint8_t deltax, deltay, x, y, steep;
+    int16_t error;  // deltax is up to 255 on wide panels
+    int8_t ystep;
+
+    GLCD_PROFILE_ENTER();
+    steep = _GLCD_absDiff(y1, y2) > _GLCD_absDiff(x1, x2);
+
+    if (steep) {
+        _GLCD_swap(x1, y1);
+        _GLCD_swap(x2, y2);
+    }
+
+    if (x1 > x2) {
+        _GLCD_swap(x1, x2);
+        _GLCD_swap(y1, y2);
+    }
+
+    deltax = x2 - x1;
+    deltay = _GLCD_absDiff(y2, y1);
+    error = deltax / 2;
+    y = y1;
+    if (y1 < y2) ystep = 1;
+    else ystep = -1;
+
+    for (x = x1;; x++) {
+        if (steep) GLCD_SetDot(y, x, color);
+        else GLCD_SetDot(x, y, color);
+        if (x == x2)
+            break;
+        error = error - deltay;
+        if (error < 0) {
+            y = y + ystep;
+            error = error + deltax;
+        }
+    }
+    GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_LINE);
+}
+
+/*
+ * Column accumulator of the polyline and sample plots. The dots of one column
+ * are collected as page bytes, so a column costs one read-modify-write per
+ * page it touches, or a plain write where a page byte is covered entirely,
+ * however many segments pass through it.
+ */
+typedef struct {
+    uint8_t x;
+    uint8_t color;  // inversion applied
+    uint8_t mask[DISPLAY_PAGES];
+} GLCD_Column;
+
+static void GLCD_ColumnStart(GLCD_Column *col, uint8_t x, uint8_t color)
+{
+    uint8_t page;
+
+    col->x = x;
+    col->color = color ^ GLCD_Inverted;
+    for (page = 0; page < DISPLAY_PAGES; page++)
+        col->mask[page] = 0;
+}
+
+static void GLCD_ColumnFlush(GLCD_Column *col)
+{
+    uint8_t page, mask, data;
+
+    for (page = 0; page < DISPLAY_PAGES; page++) {
+        mask = col->mask[page];
+        if (mask == 0)
+            continue;
+        col->mask[page] = 0;
+        GLCD_SetAddress(col->x, page * 8);
+        if (mask == 0xFF) {
+            data = col->color;
+        } else {
+            GLCD_ReadData(data);
+            data = (data & ~mask) | (col->color & mask);
+        }
+        GLCD_WriteData(data);
+    }
+}
+
+static void GLCD_ColumnDot(GLCD_Column *col, uint8_t x, uint8_t y)
+{
+    if (GLCD_PastWidth(x) || y >= DISPLAY_HEIGHT)
+        return;
+    if (x != col->x) {
+        GLCD_ColumnFlush(col);
+        col->x = x;
+    }
+    col->mask[y / 8] |= _BV(y % 8);
+}
+
+/*
+ * DrawLine's Bresenham walk, but always from x1, y1 to x2, y2 so that the
+ * segments of a polyline meet in the column they share.
+ */
+static void GLCD_ColumnLine(GLCD_Column *col, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2)
+{
+    uint8_t deltax, deltay, x, y, steep;
+    int16_t error;
+    int8_t xstep, ystep;
+
+    steep = _GLCD_absDiff(y1, y2) > _GLCD_absDiff(x1, x2);
+    if (steep) {
+        _GLCD_swap(x1, y1);
+        _GLCD_swap(x2, y2);
+    }
+
+    deltax = _GLCD_absDiff(x2, x1);
+    deltay = _GLCD_absDiff(y2, y1);
+    error = deltax / 2;
+    y = y1;
+    xstep = x1 < x2 ? 1 : -1;
+    ystep = y1 < y2 ? 1 : -1;
+
+    for (x = x1;; x += xstep) {
+        if (steep) GLCD_ColumnDot(col, y, x);
+        else GLCD_ColumnDot(col, x, y);
+        if (x == x2)
+            break;
+        error = error - deltay;
+        if (error < 0) {
+            y = y + ystep;
+            error = error + deltax;
+        }
+    }
+}
+
+/* Lines from each point to the next, the shared columns are written once */
+GLCD_API void GLCD_DrawPolyline(const lcdPoint *points, uint8_t n, uint8_t color)
+{
+    GLCD_Column col;
+    uint8_t i;
+
+    if (n == 0)
+        return;
+    GLCD_PROFILE_ENTER();
+    if (GLCD_Rotation) {
+        /* the accumulator's columns are panel columns, rotated lines go dot by dot */
+        GLCD_SetDot(points[0].x, points[0].y, color);
+        for (i = 1; i < n; i++)
+            GLCD_DrawLine(points[i - 1].x, points[i - 1].y, points[i].x, points[i].y, color);
+        GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_POLYLINE);
+        return;
+    }
+    GLCD_ColumnStart(&col, points[0].x, color);
+    GLCD_ColumnDot(&col, points[0].x, points[0].y);
+    for (i = 1; i < n; i++)
+        GLCD_ColumnLine(&col, points[i - 1].x, points[i - 1].y, points[i].x, points[i].y);
+    GLCD_ColumnFlush(&col);
+    GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_POLYLINE);
+}
+
+/* Row of a sample, pinned to the top row when it would be above the panel */
+static uint8_t GLCD_SampleRow(uint8_t sample, uint8_t yscale)
+{
+    uint8_t rise = (uint8_t) (((uint16_t) sample * yscale) >> 8);
+
+    return rise < GLCD_Height() ? GLCD_Height() - 1 - rise : 0;
+}
+
+/*
+ * Plots samples as a connected trace in columns x0 to x0 + n - 1, sample s
+ * (s * yscale) / 256 rows above the bottom row, or in the top row when that
+ * is off the panel. Each column is one vertical span from its sample halfway
+ * to the samples next to it, so the trace is built a column at a time
+ * without any line setup.
+ */
+GLCD_API void GLCD_PlotSamples(uint8_t x0, const uint8_t *samples, uint8_t n, uint8_t yscale, uint8_t color)
+{
+    GLCD_Column col;
+    uint8_t i, y, lo, hi, row;
+    int8_t d;
+
+    if (n == 0)
+        return;
+    GLCD_PROFILE_ENTER();
+    GLCD_ColumnStart(&col, x0, color);
+    for (i = 0; i < n && x0 + i < GLCD_Width(); i++) {
+        y = GLCD_SampleRow(samples[i], yscale);
+        lo = hi = y;
+        /* the middle row of an even step goes to the left column */
+        if (i > 0) {
+            d = GLCD_SampleRow(samples[i - 1], yscale) - y;
+            d = d > 0 ? (d - 1) / 2 : (d + 1) / 2;
+            if (d > 0) hi = y + d;
+            else lo = y + d;
+        }
+        if (i + 1 < n) {
+            d = (GLCD_SampleRow(samples[i + 1], yscale) - y) / 2;
+            if (d > 0 && y + d > hi) hi = y + d;
+            if (d < 0 && y + d < lo) lo = y + d;
+        }
+        if (GLCD_Rotation) {
+            GLCD_DrawVertLine(x0 + i, lo, hi - lo, color);
+            continue;
+        }
+        col.x = x0 + i;
+        for (row = lo; row <= hi; row++)
+            col.mask[row / 8] |= _BV(row % 8);
+        GLCD_ColumnFlush(&col);
+    }
+    GLCD_PROFILE_EXIT(GLCD_PROF_PLOT_SAMPLES);
+}
+
+GLCD_API void GLCD_DrawRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color)
+{
+    GLCD_PROFILE_ENTER();
+    GLCD_DrawHoriLine(x, y, width, color); // top
+    GLCD_DrawHoriLine(x, y + height, width, color); // bottom
+    GLCD_DrawVertLine(x, y, height, color); // left
+    GLCD_DrawVertLine(x + width, y, height, color); // right
+    GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_RECT);
+}
+
+GLCD_API void GLCD_DrawRoundRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t radius, uint8_t color)
+{
+    int16_t tSwitch, x1 = 0, y1 = radius;
+    GLCD_PROFILE_ENTER();
+    tSwitch = 3 - 2 * radius;
+
+    while (x1 <= y1) {
+        GLCD_SetDot(x + radius - x1, y + radius - y1, color);
+        GLCD_SetDot(x + radius - y1, y + radius - x1, color);
+
+        GLCD_SetDot(x + width - radius + x1, y + radius - y1, color);
+        GLCD_SetDot(x + width - radius + y1, y + radius - x1, color);
+
+        GLCD_SetDot(x + width - radius + x1, y + height - radius + y1, color);
+        GLCD_SetDot(x + width - radius + y1, y + height - radius + x1, color);
+
+        GLCD_SetDot(x + radius - x1, y + height - radius + y1, color);
+        GLCD_SetDot(x + radius - y1, y + height - radius + x1, color);
+
+        if (tSwitch < 0) {
+            tSwitch += (4 * x1 + 6);
+        } else {
+            tSwitch += (4 * (x1 - y1) + 10);
+            y1--;
+        }
+        x1++;
+    }
+
+    GLCD_DrawHoriLine(x + radius, y, width - (2 * radius), color); // top
+    GLCD_DrawHoriLine(x + radius, y + height, width - (2 * radius), color); // bottom
+    GLCD_DrawVertLine(x, y + radius, height - (2 * radius), color); // left
+    GLCD_DrawVertLine(x + width, y + radius, height - (2 * radius), color); // right
+    GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_ROUND_RECT);
+}
+
+/*
+ * Hardware-Functions 
+ */
+GLCD_API void GLCD_FillRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color)
+{
+    uint8_t mask, pageOffset, h, i, data, last;
+    if (GLCD_Rotation && !GLCD_ToPanel(&x, &y, &width, &height))
+        return;
+    GLCD_PROFILE_ENTER();
+    height++;
+    color ^= GLCD_Inverted;
+
+    pageOffset = y % 8;
+    y -= pageOffset;
+    mask = 0xFF;
+    if (height < 8 - pageOffset) {
+        mask >>= (8 - height);
+        h = height;
+    } else {
+        h = 8 - pageOffset;
+    }
+    mask <<= pageOffset;
+    last = (x + width < DISPLAY_WIDTH) ? x + width : DISPLAY_WIDTH - 1;
+
+    if (mask == 0xFF) {
+        /* whole first page, nothing to keep */
+        GLCD_WriteRun(y / 8, x, last, &color, 0);
+    } else {
+        GLCD_SetAddress(x, y);
+        for (i = 0; i <= width; i++) {
+            GLCD_ReadData(data);
+
+            if (color == BLACK) {
+                data |= mask;
+            } else {
+                data &= ~mask;
+            }
+
+            GLCD_WriteData(data);
+        }
+    }
+
+    while (h + 8 <= height) {
+        h += 8;
+        y += 8;
+        GLCD_WriteRun(y / 8, x, last, &color, 0);
+    }
+
+    if (h < height) {
+        mask = ~(0xFF << (height - h));
+        GLCD_SetAddress(x, y + 8);
+
+        for (i = 0; i <= width; i++) {
+            GLCD_ReadData(data);
+
+            if (color == BLACK) {
+                data |= mask;
+            } else {
+                data &= ~mask;
+            }
+
+            GLCD_WriteData(data);
+        }
+    }
+    GLCD_PROFILE_EXIT(GLCD_PROF_FILL_RECT);
+}
+
+GLCD_API void GLCD_InvertRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height)
+{
+    uint8_t mask, pageOffset, h, i, data, tmpData;
+    if (GLCD_Rotation && !GLCD_ToPanel(&x, &y, &width, &height))
+        return;
+    GLCD_PROFILE_ENTER();
+    height++;
+
+    pageOffset = y % 8;
+    y -= pageOffset;
+    mask = 0xFF;
+    if (height < 8 - pageOffset) {
+        mask >>= (8 - height);
+        h = height;
+    } else {
+        h = 8 - pageOffset;
+    }
+    mask <<= pageOffset;
+
+    GLCD_SetAddress(x, y);
+    for (i = 0; i <= width; i++) {
+        GLCD_ReadData(data);
+        tmpData = ~data;
+        data = (tmpData & mask) | (data & ~mask);
+        GLCD_WriteData(data);
+    }
+
+    while (h + 8 <= height) {
+        h += 8;
+        y += 8;
+        GLCD_SetAddress(x, y);
+
+        for (i = 0; i <= width; i++) {
+            GLCD_ReadData(data);
+            GLCD_WriteData(~data);
+        }
+    }
+
+    if (h < height) {
+        mask = ~(0xFF << (height - h));
+        GLCD_SetAddress(x, y + 8);
+
+        for (i = 0; i <= width; i++) {
+            GLCD_ReadData(data);
+            tmpData = ~data;
+            data = (tmpData & mask) | (data & ~mask);
+            GLCD_WriteData(data);
+        }
+    }
+    GLCD_PROFILE_EXIT(GLCD_PROF_INVERT_RECT);
+}
+
+/*
+ * Copies columns x to x + width and rows y to y + height so that their top
+ * left corner lands on dstX, dstY. The parts of the source and destination
+ * that overlap are handled like memmove(): the destination pages are done
+ * in the order that reads every source byte before it is overwritten.
+ *
+ * Each destination page takes a chunk of columns at a time: the one or two
+ * source pages its rows come from are read as runs, shifted together, merged
+ * with the destination bytes where the rectangle covers only part of a page,
+ * and written back as a run. With page aligned rows, moving whole pages, the
+ * destination is not read at all.
+ */
+GLCD_API void GLCD_CopyRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t dstX, uint8_t dstY)
+{
+    uint8_t lo[GLCD_INVERT_CHUNK], hi[GLCD_INVERT_CHUNK], dst[GLCD_INVERT_CHUNK];
+    uint8_t page, first, last, mask, shift, n, i, j, col, data;
+    int16_t srcRow, offset, dstLast;
+    int8_t sp, pageStep, colStep;
+
+    if (GLCD_Rotation) {
+        /* clipped at both ends, the rectangles turn on the panel */
+        if (!GLCD_ClipRect(x, y, &width, &height) || !GLCD_ClipRect(dstX, dstY, &width, &height))
+            return;
+        n = width;
+        i = height;
+        GLCD_RotateRect(&dstX, &dstY, &n, &i);
+        GLCD_RotateRect(&x, &y, &width, &height);
+    }
+    if (GLCD_PastWidth(x) || y > DISPLAY_HEIGHT - 1 || GLCD_PastWidth(dstX) || dstY > DISPLAY_HEIGHT - 1
+            || (x == dstX && y == dstY))
+        return;
+    GLCD_PROFILE_ENTER();
+    /* clipped to the panel at both ends, nothing is read past its edges */
+    if (x + width > DISPLAY_WIDTH - 1)
+        width = DISPLAY_WIDTH - 1 - x;
+    if (y + height > DISPLAY_HEIGHT - 1)
+        height = DISPLAY_HEIGHT - 1 - y;
+    if (dstX + width > DISPLAY_WIDTH - 1)
+        width = DISPLAY_WIDTH - 1 - dstX;
+    dstLast = dstY + height;
+    if (dstLast > DISPLAY_HEIGHT - 1)
+        dstLast = DISPLAY_HEIGHT - 1;
+    offset = (int16_t) y - dstY;
+
+    /* moving down or right, start at the bottom or right end */
+    first = dstY / 8;
+    last = dstLast / 8;
+    pageStep = 1;
+    if (dstY > y) {
+        _GLCD_swap(first, last);
+        pageStep = -1;
+    }
+    colStep = dstX > x ? -1 : 1;
+
+    for (page = first;; page += pageStep) {
+        mask = 0xFF;
+        if (page == dstY / 8)
+            mask <<= dstY % 8;
+        if (page == dstLast / 8)
+            mask &= 0xFF >> (7 - dstLast % 8);
+
+        /* bit 0 of the page comes from srcRow, which is at most 7 rows above the top */
+        srcRow = page * 8 + offset;
+        sp = srcRow < 0 ? -1 : srcRow / 8;
+        shift = srcRow - sp * 8;
+
+        for (i = 0; i <= width; i += n) {
+            n = width - i + 1 < GLCD_INVERT_CHUNK ? width - i + 1 : GLCD_INVERT_CHUNK;
+            col = colStep > 0 ? i : width - i - n + 1;
+
+            if (sp >= 0)
+                GLCD_ReadRun(sp, x + col, n, lo);
+            if (shift && sp + 1 < DISPLAY_PAGES)
+                GLCD_ReadRun(sp + 1, x + col, n, hi);
+            if (mask != 0xFF)
+                GLCD_ReadRun(page, dstX + col, n, dst);
+
+            for (j = 0; j < n; j++) {
+                data = sp >= 0 ? lo[j] >> shift : 0;
+                if (shift && sp + 1 < DISPLAY_PAGES)
+                    data |= hi[j] << (8 - shift);
+                if (mask != 0xFF)
+                    data = (data & mask) | (dst[j] & ~mask);
+                lo[j] = data;
+            }
+            GLCD_WriteRun(page, dstX + col, dstX + col + n - 1, lo, 1);
+        }
+        if (page == last)
+            break;
+    }
+    GLCD_PROFILE_EXIT(GLCD_PROF_COPY_RECT);
+}
+
+/*
+ * Moves the contents of the rectangle by dx, dy, dropping what leaves it and
+ * filling the uncovered strips with color. Menus and lists can scroll by a
+ * line this way instead of being drawn again.
+ */
+GLCD_API void GLCD_ScrollRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, int8_t dx, int8_t dy, uint8_t color)
+{
+    uint8_t ax = dx < 0 ? -dx : dx;
+    uint8_t ay = dy < 0 ? -dy : dy;
+
+    GLCD_PROFILE_ENTER();
+    if (ax > width || ay > height) {
+        GLCD_FillRect(x, y, width, height, color);
+        GLCD_PROFILE_EXIT(GLCD_PROF_SCROLL_RECT);
+        return;
+    }
+
+    GLCD_CopyRect(dx < 0 ? x + ax : x, dy < 0 ? y + ay : y, width - ax, height - ay,
+            dx > 0 ? x + ax : x, dy > 0 ? y + ay : y);
+
+    if (dx > 0)
+        GLCD_FillRect(x, y, ax - 1, height, color);
+    else if (dx < 0)
+        GLCD_FillRect(x + width - ax + 1, y, ax - 1, height, color);
+    if (dy > 0)
+        GLCD_FillRect(x, y, width, ay - 1, color);
+    else if (dy < 0)
+        GLCD_FillRect(x, y + height - ay + 1, width, ay - 1, color);
+    GLCD_PROFILE_EXIT(GLCD_PROF_SCROLL_RECT);
+}
+
+/*
+ * Inversion is not applied to every byte on the bus. The display memory always
+ * holds what is shown on the panel, so reads need no correction, and every
+ * drawing function folds GLCD_Inverted into its color once before writing.
+ * Toggling only has to flip what is already on the screen, which is done
+ * a burst at a time with sequential reads followed by sequential writes.
+ */
+GLCD_API void GLCD_SetInverted(boolean invert)
+{ // changed type to boolean
+    uint8_t mask;
+
+    mask = invert ? 0xFF : 0x00;
+    if (GLCD_Inverted == mask)
+        return;
+    GLCD_PROFILE_ENTER();
+
+#ifdef GLCD_FRAMEBUFFER
+    /* flipped in RAM, the panel gets it in one pass of GLCD_Service() */
+    uint8_t *p = &GLCD_Frame[0][0];
+    for (uint16_t n = sizeof (GLCD_Frame); n > 0; n--, p++)
+        *p = ~*p;
+    GLCD_FrameDirtyAll();
+#else
+    uint8_t buf[GLCD_INVERT_CHUNK];
+    uint8_t i, x, y, chip, col;
+
+    for (y = 0; y < DISPLAY_HEIGHT; y += 8) {
+        for (chip = 0; chip < GLCD_CHIP_COUNT; chip++) {
+          for (col = 0; col < CHIP_WIDTH; col += GLCD_INVERT_CHUNK) {
+            x = chip * CHIP_WIDTH + col;
+            GLCD_ReadRun(y / 8, x, GLCD_INVERT_CHUNK, buf);
+
+            for (i = 0; i < GLCD_INVERT_CHUNK; i++)
+                buf[i] = ~buf[i];
+            GLCD_WriteRun(y / 8, x, x + GLCD_INVERT_CHUNK - 1, buf, 1);
+          }
+        }
+    }
+#endif
+    GLCD_Inverted = mask;
+    GLCD_PROFILE_EXIT(GLCD_PROF_SET_INVERTED);
+}
+
+GLCD_API void GLCD_SetDot(uint8_t x, uint8_t y, uint8_t color)
+{
+    uint8_t data, width = 0, height = 0;
+
+    if (GLCD_Rotation && !GLCD_ToPanel(&x, &y, &width, &height))
+        return;
+    GLCD_PROFILE_ENTER();
+    color ^= GLCD_Inverted;
+
+    GLCD_SetAddress(x, y - y % 8); // read data from display memory
+
+    GLCD_ReadData(data);
+    if (color == BLACK) {
+        data |= 0x01 << (y % 8); // set dot
+    } else {
+        data &= ~(0x01 << (y % 8)); // clear dot
+    }
+    GLCD_WriteData(data); // write data back to display
+    GLCD_PROFILE_EXIT(GLCD_PROF_SET_DOT);
+}
+
+//
+// Font Functions
+//
+
+GLCD_API void GLCD_SelectFontEx(const uint8_t* font, uint8_t color, FontCallback callback)
+{
+    GLCD_Font = font;
+    GLCD_SetFontReader(callback);
+    GLCD_FontColor = color;
+}
+
+GLCD_API void GLCD_PrintNumber(long n)
+{
+    byte buf[10]; // prints up to 10 digits
+    byte i = 0;
+    if (n == 0)
+        GLCD_PutChar('0');
+    else {
+        if (n < 0) {
+            GLCD_PutChar('-');
+            n = -n;
+        }
+        while (n > 0 && i <= 10) {
+            buf[i++] = n % 10; // n % base
+            n /= 10; // n/= base
+        }
+        for (; i > 0; i--)
+            GLCD_PutChar((char) (buf[i - 1] < 10 ? '0' + buf[i - 1] : 'A' + buf[i - 1] - 10));
+    }
+}
+
+GLCD_API void GLCD_PrintHexNumber(uint16_t n)
+{
+    int8_t i;
+    uint8_t d, previous_write = 0;
+
+    if (n == 0) {
+        GLCD_PutChar('0');
+        return;
+    }
+    
+    for (i=3; i>=0; i--) {
+        d = ((0x0F << i*4) & n) >> i*4;
+
+        if (d < 0xA)
+            d += '0';
+        else
+            d = (d - 0xA) + 'A';
+        
+        if (d != '0' || previous_write) {
+            GLCD_PutChar((char) d);
+            previous_write = 1;
+        }
+    }
+}
+
+GLCD_API void GLCD_PrintRealNumber(double n)
+{
+    long int_part, frac_part;
+    uint8_t sign = 0;
+
+    if (n < 0) {
+        sign = 1;
+        n *= -1;
+    }
+    
+    int_part = (long)n;
+    frac_part = (long)((n - (double)int_part)*1000000);
+    if (sign) GLCD_PutChar('-');
+    GLCD_PrintNumber(int_part);
+    GLCD_PutChar('.');
+
+    while ((frac_part != 0) && (frac_part % 10 == 0)) {
+        frac_part /= 10;
+    }
+    
+    GLCD_PrintNumber(frac_part);
+}
+
+#undef GLCD_OLD_FONTDRAW
+
+static uint16_t GLCD_FontWord(uint16_t at)
+{
+    return (uint16_t) GLCD_FontRead(GLCD_Font + at) << 8 | GLCD_FontRead(GLCD_Font + at + 1);
+}
+
+/*
+ * Glyph of code in a range font: a binary search for its range, then a
+ * direct index into a fixed width range, or the widths of the glyphs before
+ * it in the range. A code the font lacks gets the fallback glyph.
+ */
+static uint16_t GLCD_RangeGlyph(uint16_t code, uint8_t *width)
+{
+    uint8_t bytes = (GLCD_FontRead(GLCD_Font + FONT_HEIGHT) + 7) / 8;
+    uint8_t fixed = GLCD_FontRead(GLCD_Font + FONT_FIXED_WIDTH);
+    uint8_t ranges = GLCD_FontRead(GLCD_Font + FONT_RANGE_COUNT);
+    uint16_t widths = FONT_RANGES + ranges * FONT_RANGE_SIZE;
+    uint16_t data = widths + (fixed ? 0 : GLCD_FontWord(FONT_GLYPH_COUNT));
+    uint16_t range, first, glyph, column;
+    uint8_t lo, hi, mid, i, tries;
+
+    for (tries = 0; tries < 2; tries++) {
+        lo = 0;
+        hi = ranges;
+        while (lo < hi) {
+            mid = (lo + hi) / 2;
+            range = FONT_RANGES + mid * FONT_RANGE_SIZE;
+            first = GLCD_FontWord(range);
+            if (code < first) {
+                hi = mid;
+            } else if (code - first >= GLCD_FontRead(GLCD_Font + range + 2)) {
+                lo = mid + 1;
+            } else {
+                i = code - first;
+                column = GLCD_FontWord(range + 5);
+                if (fixed) {
+                    *width = fixed;
+                    column += i * fixed;
+                } else {
+                    glyph = GLCD_FontWord(range + 3);
+                    for (; i > 0; i--)
+                        column += GLCD_FontRead(GLCD_Font + widths + glyph++);
+                    *width = GLCD_FontRead(GLCD_Font + widths + glyph);
+                }
+                return data + column * bytes;
+            }
+        }
+        code = GLCD_FontWord(FONT_FALLBACK);
+    }
+    return 0;
+}
+
+/*
+ * Offset of the glyph of code in the current font and its width, or 0 if
+ * the font has no glyph for code.
+ */
+static uint16_t GLCD_GlyphIndex(uint16_t code, uint8_t *width)
+{
+    uint8_t height = GLCD_FontRead(GLCD_Font + FONT_HEIGHT);
+    uint8_t bytes = (height + 7) / 8; /* calculates height in rounded up bytes */
+
+    uint8_t firstChar = GLCD_FontRead(GLCD_Font + FONT_FIRST_CHAR);
+    uint8_t charCount = GLCD_FontRead(GLCD_Font + FONT_CHAR_COUNT);
+
+    uint16_t index = 0;
+
+    if (isRangeFont(GLCD_Font))
+        return GLCD_RangeGlyph(code, width);
+    if (code < firstChar || code >= (firstChar + charCount)) {
+        return 0; // invalid char
+    }
+    code -= firstChar;
+
+    if (isFixedWidthFont(GLCD_Font)) {
+        *width = GLCD_FontRead(GLCD_Font + FONT_FIXED_WIDTH);
+        return code * bytes * *width + FONT_WIDTH_TABLE;
+    }
+
+    // variable width font, read width data, to get the index
+    /*
+     * Because there is no table for the offset of where the data
+     * for each character glyph starts, run the table and add up all the
+     * widths of all the characters prior to the character we
+     * need to locate.
+     */
+    for (uint8_t i = 0; i < code; i++) {
+        index += GLCD_FontRead(GLCD_Font + FONT_WIDTH_TABLE + i);
+    }
+    /*
+     * Calculate the offset of where the font data
+     * for our character starts.
+     * The index value from above has to be adjusted because
+     * there is potentialy more than 1 byte per column in the glyph,
+     * when the characgter is taller than 8 bits.
+     * To account for this, index has to be multiplied
+     * by the height in bytes because there is one byte of font
+     * data for each vertical 8 pixels.
+     * The index is then adjusted to skip over the font width data
+     * and the font header information.
+     */
+
+    index = index * bytes + charCount + FONT_WIDTH_TABLE;
+
+    /*
+     * Finally, fetch the width of our character
+     */
+    *width = GLCD_FontRead(GLCD_Font + FONT_WIDTH_TABLE + code);
+    return index;
+}
+
+/* What measuring text needs of the font, read once per string */
+typedef struct {
+    uint8_t first, count;   // no character range in a range font
+    uint8_t fixed;          // width of every glyph, 0 if there is a width table
+} GLCD_Metrics;
+
+static void GLCD_GetMetrics(GLCD_Metrics *metrics)
+{
+    metrics->first = GLCD_FontRead(GLCD_Font + FONT_FIRST_CHAR);
+    metrics->count = GLCD_FontRead(GLCD_Font + FONT_CHAR_COUNT);
+    metrics->fixed = isFixedWidthFont(GLCD_Font) ? GLCD_FontRead(GLCD_Font + FONT_FIXED_WIDTH) : 0;
+}
+
+/* Columns drawing code advances the text position, its gap included, 0 if the font lacks it */
+static uint8_t GLCD_Advance(const GLCD_Metrics *metrics, uint16_t code)
+{
+    uint8_t width;
+
+    if (metrics->count == 0)
+        return GLCD_RangeGlyph(code, &width) ? width + 1 : 0;
+    if (code < metrics->first || code >= metrics->first + metrics->count)
+        return 0;
+    if (metrics->fixed)
+        return metrics->fixed + 1;
+    return GLCD_FontRead(GLCD_Font + FONT_WIDTH_TABLE + (code - metrics->first)) + 1;
+}
+
+/*
+ * Code of the character at *str, which is moved past it. Plain text is
+ * Latin-1, one code per byte. In UTF-8 a malformed sequence, an overlong
+ * form, a surrogate or a code beyond 16 bits gives U+FFFD.
+ */
+static uint16_t GLCD_NextCode(const char **str, uint8_t utf8)
+{
+    const uint8_t *s = (const uint8_t *) *str;
+    uint16_t code = *s++;
+    uint16_t least = 0;
+    uint8_t more = 0;
+
+    if (utf8 && code >= 0x80) {
+        if (code >= 0xC2 && code < 0xE0) {
+            code &= 0x1F;
+            more = 1;
+        } else if (code >= 0xE0 && code < 0xF0) {
+            code &= 0x0F;
+            more = 2;
+            least = 0x800;
+        } else {
+            code = 0xFFFD;
+            while ((*s & 0xC0) == 0x80)
+                s++;
+        }
+        for (; more > 0 && (*s & 0xC0) == 0x80; more--)
+            code = code << 6 | (*s++ & 0x3F);
+        if (more || code < least || (code & 0xF800) == 0xD800)
+            code = 0xFFFD;
+    }
+    *str = (const char *) s;
+    return code;
+}
+
+/*
+ * A line of text as the image source of GLCD_DrawRotated(): the pages of
+ * all its glyphs side by side, each glyph followed by its gap column.
+ */
+typedef struct {
+    const char *str;
+    const char *next;       // character after the current glyph
+    uint8_t width;          // columns of the line
+    uint8_t pos;            // columns of the current page sent
+    uint8_t page;
+    uint8_t height;
+    uint8_t shift;          // Thiele's residual bits of the last page
+    uint16_t index;         // current glyph
+    uint8_t glyphWidth;
+    uint8_t col;            // column of the current glyph
+    uint8_t utf8;
+} GLCD_Text;
+
+static uint8_t GLCD_TextSource(void *source, uint8_t *buf, uint8_t n)
+{
+    GLCD_Text *text = (GLCD_Text *) source;
+    uint8_t i, data;
+
+    for (i = 0; i < n; i++) {
+        if (text->pos == text->width) {
+            text->next = text->str;
+            text->pos = 0;
+            text->page++;
+            text->col = text->glyphWidth + 1;
+        }
+        while (text->col > text->glyphWidth) {
+            text->index = GLCD_GlyphIndex(GLCD_NextCode(&text->next, text->utf8), &text->glyphWidth);
+            text->col = text->index ? 0 : text->glyphWidth + 1;
+        }
+
+        data = 0; // gap column
+        if (text->col < text->glyphWidth && text->page < (text->height + 7) / 8) {
+            data = GLCD_FontRead(GLCD_Font + text->index + (uint16_t) text->page * text->glyphWidth + text->col);
+            if (text->page == (text->height - 1) / 8)
+                data >>= text->shift;
+        }
+        text->col++;
+        text->pos++;
+        buf[i] = data;
+    }
+    return n;
+}
+
+/*
+ * Draws text, UTF-8 if utf8 is set, up to a newline, the end of str or end,
+ * which may be 0, at the rotated text position and returns where it stopped.
+ * The whole line is one rotated image, so only the page bytes at its two
+ * ends are read back.
+ */
+static const char *GLCD_PutLine(const char *str, const char *end, uint8_t utf8)
+{
+    GLCD_Metrics metrics;
+    GLCD_Text text;
+    uint16_t width = 0;
+
+    if (GLCD_Font == 0)
+        return str;
+    GLCD_GetMetrics(&metrics);
+    text.str = str;
+    while (str != end && *str != 0 && *str != '\n')
+        width += GLCD_Advance(&metrics, GLCD_NextCode(&str, utf8));
+    if (width == 0)
+        return str;
+
+    text.next = text.str;
+    text.width = width < 255 ? width : 255;
+    text.pos = 0;
+    text.page = 0;
+    text.height = GLCD_FontRead(GLCD_Font + FONT_HEIGHT);
+    text.shift = isThieleFont(GLCD_Font) && (text.height & 7) ? 8 - (text.height & 7) : 0;
+    text.glyphWidth = 0;
+    text.col = 1;
+    text.utf8 = utf8;
+    GLCD_DrawRotated(GLCD_TextSource, &text, GLCD_Cursor.x, GLCD_Cursor.y,
+            text.width, text.height, text.width, text.height + 1, ~(GLCD_FontColor ^ GLCD_Inverted));
+    if (GLCD_Cursor.x + width < 256)
+        GLCD_GotoXY(GLCD_Cursor.x + width, GLCD_Cursor.y);
+    return str;
+}
+
+/*
+ * Draws the glyph of code at the text position. While rotated only the
+ * codes of GLCD_PutChar() come here, UTF-8 lines go to GLCD_PutLine() whole.
+ */
+static int GLCD_PutGlyph(uint16_t code)
+{
+    if (GLCD_Font == 0)
+        return 0; // no font selected
+    if (code < 0x20)
+        return 1;
+
+    uint8_t width = 0;
+    uint8_t height = GLCD_FontRead(GLCD_Font + FONT_HEIGHT);
+
+    uint16_t index;
+    uint8_t x = GLCD_Coord.x, y = GLCD_Coord.y;
+    uint8_t thielefont;
+    uint8_t fontColor = GLCD_FontColor ^ GLCD_Inverted;
+
+    index = GLCD_GlyphIndex(code, &width);
+    if (index == 0) {
+        return 0; // invalid char
+    }
+    GLCD_PROFILE_ENTER(); // glyphs drawn only
+    thielefont = isThieleFont(GLCD_Font);
+
+    if (GLCD_Rotation) {
+        char line[2];
+
+        line[0] = (char) code;
+        line[1] = 0;
+        GLCD_PutLine(line, 0, 0);
+        GLCD_PROFILE_EXIT(GLCD_PROF_PUT_CHAR);
+        return 1;
+    }
+
+    // last but not least, draw the character
+#ifdef GLCD_OLD_FONTDRAW
+    /*================== OLD FONT DRAWING ============================*/
+    uint8_t bytes = (height + 7) / 8; /* calculates height in rounded up bytes */
+
+    GLCD_SetAddress(x, y);
+
+    /*
+     * Draw each column of the glyph (character) horizontally
+     * 8 bits (1 page) at a time.
+     * i.e. if a font is taller than 8 bits, draw upper 8 bits first,
+     * Then drop down and draw next 8 bits and so on, until done.
+     * This code depends on WriteData() doing writes that span LCD
+     * memory pages, which has issues because the font data isn't
+     * always a multiple of 8 bits.
+     */
+
+    for (uint8_t i = 0; i < bytes; i++) /* each vertical byte */ {
+        uint16_t page = i*width; // page must be 16 bit to prevent overflow
+        for (uint8_t j = 0; j < width; j++) /* each column */ {
+            uint8_t data = GLCD_FontRead(GLCD_Font + index + page + j);
+
+            /*
+             * This funkyness is because when the character glyph is not a
+             * multiple of 8 in height, the residual bits in the font data
+             * were aligned to the incorrect end of the byte with respect
+             * to the GLCD. I believe that this was an initial oversight (bug)
+             * in Thieles font creator program. It is easily fixed
+             * in the font program but then creates a potential backward
+             * compatiblity problem.
+             *	--- bperrybap
+             */
+
+            if (height > 8 && height < (i + 1)*8) /* is it last byte of multibyte tall font? */ {
+                data >>= (i + 1)*8 - height;
+            }
+
+            GLCD_WriteData(data ^ ~fontColor);
+        }
+        // 1px gap between chars
+        GLCD_WriteData(~fontColor);
+        GLCD_SetAddress(x, GLCD_Coord.y + 8);
+    }
+    GLCD_SetAddress(x + width + 1, y);
+
+    /*================== END of OLD FONT DRAWING ============================*/
+#else
+
+    /*================== NEW FONT DRAWING ===================================*/
+
+    /*
+     * Paint font data bits and write them to LCD memory 1 LCD page at a time.
+     * This is very different from simply reading 1 byte of font data
+     * and writing all 8 bits to LCD memory and expecting the write data routine
+     * to fragement the 8 bits across LCD 2 memory pages when necessary.
+     * That method (really doesn't work) and reads and writes the same LCD page
+     * more than once as well as not do sequential writes to memory.
+     *
+     * This method of rendering while much more complicated, somewhat scrambles the font
+     * data reads to ensure that all writes to LCD pages are always sequential and a given LCD
+     * memory page is never read or written more than once.
+     * And reads of LCD pages are only done at the top or bottom of the font data rendering
+     * when necessary.
+     * i.e it ensures the absolute minimum number of LCD page accesses
+     * as well as does the sequential writes as much as possible.
+     *
+     */
+
+    uint8_t pixels = height + 1; /* 1 for gap below character*/
+    uint8_t p;
+    uint8_t dy;
+    uint8_t tfp;
+    uint8_t dp;
+    uint8_t dbyte;
+    uint8_t fdata;
+
+    for (p = 0; p < pixels;) {
+        dy = y + p;
+
+        /*
+         * Align to proper Column and page in LCD memory
+         */
+
+        GLCD_SetAddress(x, (dy & ~7));
+
+        uint16_t page = p / 8 * width; // page must be 16 bit to prevent overflow
+
+        for (uint8_t j = 0; j < width; j++) /* each column of font data */ {
+
+            /*
+             * Fetch proper byte of font data.
+             * Note:
+             * This code "cheats" to add the horizontal space/pixel row
+             * below the font.
+             * It essentially creates a font pixel of 0 when the pixels are
+             * out of the defined pixel map.
+             *
+             * fake a fondata read read when we are on the very last
+             * bottom "pixel". This lets the loop logic continue to run
+             * with the extra fake pixel. If the loop is not the
+             * the last pixel the pixel will come from the actual
+             * font data, but that is ok as it is 0 padded.
+             *
+             */
+
+            if (p >= height) {
+                /*
+                 * fake a font data read for padding below character.
+                 */
+                fdata = 0;
+            } else {
+                fdata = GLCD_FontRead(GLCD_Font + index + page + j);
+
+                /*
+                 * Have to shift font data because Thiele shifted residual
+                 * font bits the wrong direction for LCD memory.
+                 *
+                 * The real solution to this is to fix the variable width font format to
+                 * not shift the residual bits the wrong direction!!!!
+                 */
+                if (thielefont && (height - (p&~7)) < 8) {
+                    fdata >>= 8 - (height & 7);
+                }
+            }
+
+            fdata ^= ~fontColor; /* inverted data for "white" font color	*/
+
+
+            /*
+             * Check to see if a quick full byte write of font
+             * data can be done.
+             */
+
+            if (!(dy & 7) && !(p & 7) && ((pixels - p) >= 8)) {
+                /*
+                 * destination pixel is on a page boundary
+                 * Font data is on byte boundary
+                 * And there are 8 or more pixels left
+                 * to paint so a full byte write can be done.
+                 */
+
+                GLCD_WriteData(fdata);
+                continue;
+            } else {
+                /*
+                 * No, so must fetch byte from LCD memory.
+                 */
+                GLCD_ReadData(dbyte);
+            }
+
+            /*
+             * At this point there is either not a full page of data
+             * left to be painted  or the font data spans multiple font
+             * data bytes. (or both) So, the font data bits will be painted
+             * into a byte and then written to the LCD memory.page.
+             */
+
+
+            tfp = p; /* font pixel bit position 		*/
+            dp = dy & 7; /* data byte pixel bit position */
+
+            /*
+             * paint bits until we hit bottom of page/byte
+             * or run out of pixels to paint.
+             */
+            while ((dp <= 7) && (tfp) < pixels) {
+                if (fdata & _BV(tfp & 7)) {
+                    dbyte |= _BV(dp);
+                } else {
+                    dbyte &= ~_BV(dp);
+                }
+
+                /*
+                 * Check for crossing font data bytes
+                 */
+                if ((tfp & 7) == 7) {
+                    /* the next font page, or the gap row below the last one */
+                    fdata = tfp + 1 < height ? GLCD_FontRead(GLCD_Font + index + page + j + width) : 0;
+
+                    /*
+                     * Have to shift font data because Thiele shifted residual
+                     * font bits the wrong direction for LCD memory.
+                     *
+                     */
+
+                    if ((thielefont) && ((height - tfp) < 8)) {
+                        fdata >>= (8 - (height & 7));
+                    }
+
+                    fdata ^= ~fontColor; /* inverted data for "white" color	*/
+                }
+                tfp++;
+                dp++;
+            }
+
+            /*
+             * Now flush out the painted byte.
+             */
+            GLCD_WriteData(dbyte);
+        }
+
+        /*
+         * now create a horizontal gap (vertical line of pixels) between characters.
+         * Since this gap is "white space", the pixels painted are oposite of the
+         * font color.
+         *
+         * Since full LCD pages are being written, there are 4 combinations of filling
+         * in the this gap page.
+         *	- pixels start at bit 0 and go down less than 8 bits
+         *	- pixels don't start at 0 but go down through bit 7
+         *	- pixels don't start at 0 and don't go down through bit 7 (fonts shorter than 6 hi)
+         *	- pixels start at bit 0 and go down through bit 7 (full byte)
+         *
+         * The code below creates a mask of the bits that should not be painted.
+         *
+         * Then it is easy to paint the desired bits since if the color is WHITE,
+         * the paint bits are set, and if the coloer is not WHITE the paint bits are stripped.
+         * and the paint bits are the inverse of the desired bits mask.
+         */
+
+
+
+        if ((dy & 7) || (pixels - p < 8)) {
+            uint8_t mask = 0;
+
+            GLCD_ReadData(dbyte);
+
+            if (dy & 7)
+                mask |= _BV(dy & 7) - 1;
+
+            if ((pixels - p) < 8)
+                mask |= ~(_BV(pixels - p) - 1);
+
+
+            if (fontColor == WHITE)
+                dbyte |= ~mask;
+            else
+                dbyte &= mask;
+
+        } else {
+            dbyte = ~fontColor;
+        }
+
+        GLCD_WriteData(dbyte);
+
+        /*
+         * advance the font pixel for the pixels
+         * just painted.
+         */
+
+        p += 8 - (dy & 7);
+    }
+
+
+    /*
+     * Since this rendering code always starts off with a GotoXY() it really isn't necessary
+     * to do a real GotoXY() to set the h/w location after rendering a character.
+     * We can get away with only setting the s/w version of X & Y.
+     *
+     * Since y didn't change while rendering, it is still correct.
+     * But update x for the pixels rendered.
+     *
+     */
+
+    GLCD_SetAddress(x + width + 1, y);
+
+    /*================== END of NEW FONT DRAWING ============================*/
+
+#endif // NEW_FONTDRAW
+
+    GLCD_PROFILE_EXIT(GLCD_PROF_PUT_CHAR);
+    return 1; // valid char
+}
+
+GLCD_API int GLCD_PutChar(char c)
+{
+    if (GLCD_Font == 0)
+        return 0; // no font selected
+
+    /*
+     * check for special character processing
+     */
+
+    if ((uint8_t) c < 0x20) { // bytes from 0x80 are Latin-1 codes, as in GLCD_NextCode()
+        //SpecialChar(c);
+        return 1;
+    }
+    return GLCD_PutGlyph((uint8_t) c);
+}
+
+static void GLCD_PutText(const char *str, uint8_t utf8)
+{
+    int x = GLCD_TextX();
+
+    while (*str != 0) {
+        if (*str == '\n') {
+            GLCD_GotoXY(x, GLCD_TextY() + GLCD_FontRead(GLCD_Font + FONT_HEIGHT));
+            str++;
+        } else if (GLCD_Rotation) {
+            str = GLCD_PutLine(str, 0, utf8);
+        } else if (utf8) {
+            GLCD_PutGlyph(GLCD_NextCode(&str, 1));
+        } else {
+            GLCD_PutChar(*str++);
+        }
+    }
+}
+
+GLCD_API void GLCD_Puts(const char *str)
+{
+    GLCD_PROFILE_ENTER();
+    GLCD_PutText(str, 0);
+    GLCD_PROFILE_EXIT(GLCD_PROF_PUTS);
+}
+
+/*
+ * With a range font any code up to U+FFFF can have a glyph, and the ones
+ * that don't get the font's fallback glyph. Other fonts show the codes in
+ * their character range.
+ */
+GLCD_API void GLCD_PutsUtf8(const char *str)
+{
+    GLCD_PROFILE_ENTER();
+    GLCD_PutText(str, 1);
+    GLCD_PROFILE_EXIT(GLCD_PROF_PUTS_UTF8);
+}
+
+/* Fixed width fonts have no width table, every glyph is FONT_FIXED_WIDTH wide */
+GLCD_API uint8_t GLCD_CharWidth(char c)
+{
+    GLCD_Metrics metrics;
+
+    if (GLCD_Font == 0)
+        return 0;
+    GLCD_GetMetrics(&metrics);
+    return GLCD_Advance(&metrics, (uint8_t) c);
+}
+
+GLCD_API uint16_t GLCD_StringWidth(const char *str)
+{
+    GLCD_Metrics metrics;
+    uint16_t width = 0;
+
+    if (GLCD_Font == 0)
+        return 0;
+    GLCD_GetMetrics(&metrics);
+    while (*str != 0)
+        width += GLCD_Advance(&metrics, (uint8_t) *str++);
+    return width;
+}
+
+/* Draws str up to end, or its end if that is 0, at the text position */
+static void GLCD_PutRun(const char *str, const char *end, uint8_t utf8)
+{
+    if (GLCD_Rotation)
+        GLCD_PutLine(str, end, utf8);
+    else if (utf8)
+        while (str != end && *str != 0)
+            GLCD_PutGlyph(GLCD_NextCode(&str, 1));
+    else
+        while (str != end && *str != 0)
+            GLCD_PutChar(*str++);
+}
+
+/*
+ * Each line is measured in one pass over the width table, up to the first
+ * character that doesn't fit. With GLCD_TEXT_WRAP the line then breaks at the
+ * last space before it, or in the middle of a word as long as the line.
+ * Without it the rest of the line is dropped. An ellipsis takes characters
+ * back off the end until it fits. Only whole lines are drawn, and the columns
+ * and rows the text leaves free are filled with the background, so new text
+ * replaces the old. GLCD_TEXT_UTF8 reads str as UTF-8, like GLCD_PutsUtf8().
+ */
+GLCD_API const char *GLCD_TextBox(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const char *str, uint8_t flags)
+{
+    GLCD_Metrics metrics;
+    const char *end, *next, *space, *after;
+    uint16_t room = width + 1, used, usedAtSpace, dots;
+    int16_t rows = height + 1;
+    uint8_t utf8 = (flags & GLCD_TEXT_UTF8) != 0;
+    uint8_t pitch, background, cut, ellipsis, offset, advance;
+
+    if (GLCD_Font == 0)
+        return str;
+    GLCD_PROFILE_ENTER();
+    GLCD_GetMetrics(&metrics);
+    pitch = GLCD_FontRead(GLCD_Font + FONT_HEIGHT) + 1;
+    background = ~GLCD_FontColor;
+    dots = 3 * GLCD_Advance(&metrics, '.');
+
+    for (; rows >= pitch; rows -= pitch, y += pitch) {
+        used = 0;
+        usedAtSpace = 0;
+        space = 0;
+        for (end = str; *end != 0 && *end != '\n'; end = after) {
+            after = end;
+            advance = GLCD_Advance(&metrics, GLCD_NextCode(&after, utf8));
+            if (*end == ' ') {
+                space = end;
+                usedAtSpace = used;
+            }
+            if (used + advance > room)
+                break;
+            used += advance;
+        }
+
+        next = end;
+        cut = *end != 0 && *end != '\n';
+        if (cut && (flags & GLCD_TEXT_WRAP)) {
+            if (space && space > str) {
+                end = space;
+                used = usedAtSpace;
+            }
+            next = end;
+            while (*next == ' ')
+                next++;
+            cut = 0;
+        } else if (cut) {
+            while (*next != 0 && *next != '\n')
+                next++;
+        }
+        if (*next == '\n')
+            next++;
+
+        ellipsis = (flags & GLCD_TEXT_ELLIPSIS) && (cut || (rows < 2 * pitch && *next != 0));
+        if (ellipsis) {
+            while (end > str && used + dots > room) {
+                do
+                    end--;
+                while (utf8 && end > str && (*end & 0xC0) == 0x80);
+                after = end;
+                used -= GLCD_Advance(&metrics, GLCD_NextCode(&after, utf8));
+            }
+            if (used + dots <= room)
+                used += dots;
+            else
+                ellipsis = 0;
+        }
+
+        offset = 0;
+        if (flags & GLCD_ALIGN_RIGHT)
+            offset = room - used;
+        else if (flags & GLCD_ALIGN_CENTER)
+            offset = (room - used) / 2;
+        if (offset)
+            GLCD_FillRect(x, y, offset - 1, pitch - 1, background);
+        GLCD_GotoXY(x + offset, y);
+        GLCD_PutRun(str, end, utf8);
+        if (ellipsis)
+            GLCD_PutRun("...", 0, 0);
+        if (offset + used < room)
+            GLCD_FillRect(x + offset + used, y, room - offset - used - 1, pitch - 1, background);
+        str = next;
+    }
+    if (rows > 0)
+        GLCD_FillRect(x, y, width, rows - 1, background);
+    GLCD_PROFILE_EXIT(GLCD_PROF_TEXT_BOX);
+    return str;
+}
+
+GLCD_API void GLCD_CursorTo(uint8_t x, uint8_t y)
+{ // 0 based coordinates for fixed width fonts (i.e. systemFont5x7)
+    GLCD_GotoXY(x * (GLCD_FontRead(GLCD_Font + FONT_FIXED_WIDTH) + 1),
+            y * (GLCD_FontRead(GLCD_Font + FONT_HEIGHT) + 1));
+}
+
+/*
+ * Sets the text position. While rotated it is kept in logical coordinates
+ * for GLCD_PutChar(), the panel address is left alone.
+ */
+GLCD_API void GLCD_GotoXY(uint8_t x, uint8_t y)
+{
+    if (GLCD_Rotation) {
+        if (x > DISPLAY_HEIGHT - 1 || GLCD_PastWidth(y))
+            return;
+        GLCD_Cursor.x = x;
+        GLCD_Cursor.y = y;
+    } else {
+        GLCD_SetAddress(x, y);
+    }
+}
+
+GLCD_API void GLCD_SetRotation(uint8_t rotation)
+{
+    if (rotation != GLCD_ROTATE_90 && rotation != GLCD_ROTATE_270)
+        rotation = GLCD_ROTATE_0;
+    GLCD_Rotation = rotation;
+    GLCD_Cursor.x = 0;
+    GLCD_Cursor.y = 0;
+}
+
+/* Moves the panel address, where the next read or write goes */
+static void GLCD_SetAddress(uint8_t x, uint8_t y)
+{
+    if (GLCD_PastWidth(x) || (y > DISPLAY_HEIGHT - 1)) // exit if coordinates are not legal
+        return;
+    GLCD_Coord.x = x; // save new coordinates
+    GLCD_Coord.y = y;
+
+#ifdef GLCD_FRAMEBUFFER
+    GLCD_Coord.page = y / 8; // the frame is addressed directly, nothing to send
+#else
+    uint8_t chip, cmd;
+
+    if (y / 8 != GLCD_Coord.page) {
+        GLCD_Coord.page = y / 8;
+        cmd = LCD_SET_PAGE | GLCD_Coord.page; // set y address on all chips
+        for (chip = 0; chip < GLCD_CHIP_COUNT; chip++) {
+            GLCD_WriteCommand(cmd, chip);
+        }
+    }
+    chip = GLCD_ChipOf(GLCD_Coord.x);
+    x = GLCD_ChipCol(x);
+    cmd = LCD_SET_ADD | x;
+    GLCD_WriteCommand(cmd, chip); // set x address on active chip
+#endif
+}
+
+/*
+ * Reads the status register of a chip with a single EN pulse, leaving the
+ * chip selected for the following GLCD_BusWrite.
+ */
+static uint8_t GLCD_ReadStatus(uint8_t chip)
+{
+    GLCD_SelectChip(chip);
+    return GLCD_BusRead(0);
+}
+
+/*
+ * Returns a bit per chip that never left reset within GLCD_INIT_TIMEOUT
+ * polls, bit 0 for the left chip, so 0 when the whole panel is up.
+ */
+GLCD_API uint8_t GLCD_Init(boolean invert)
+{
+    uint8_t chip, ready;
+    uint16_t timeout;
+
+    /* User must Declare PINs as OUTPUT */
+    GLCD_PROFILE_ENTER();
+
+    GLCD_BusInit();
+
+#ifdef GLCD_BusReset
+    /*
+     * Reset the glcd module if there is a reset pin defined. RST is shared by
+     * all the panels, so it is only pulsed for the first one.
+     */
+#if GLCD_PANELS > 1
+    if (GLCD_Ctx.panel == 0)
+#endif
+    {
+        GLCD_BusReset();
+    }
+#endif
+
+    /*
+     * Instead of blind delays for the reset signal to rise and the glcd to
+     * get up and running, poll the chips in turn and turn each one on as
+     * soon as its status shows it left reset. A chip that never does within
+     * GLCD_INIT_TIMEOUT polls is left off and reported to the caller. The
+     * accesses that follow don't wait for it, nor does the frame output
+     * send to it, so the rest of the panel keeps working.
+     */
+    GLCD_Off = 0;
+    ready = 0;
+    for (timeout = GLCD_INIT_TIMEOUT; timeout > 0 && ready != _BV(GLCD_CHIP_COUNT) - 1; timeout--) {
+        for (chip = 0; chip < GLCD_CHIP_COUNT; chip++) {
+            if ((ready & _BV(chip)) || (GLCD_ReadStatus(chip) & (LCD_BUSY_FLAG | LCD_RESET_FLAG)))
+                continue;
+            GLCD_BusWrite(0, LCD_ON); // power on
+            GLCD_MarkBusy(chip);
+            GLCD_WriteCommand(LCD_DISP_START, chip); // display start line = 0
+            ready |= _BV(chip);
+        }
+    }
+
+    GLCD_Off = (uint8_t) ~ready & (_BV(GLCD_CHIP_COUNT) - 1);
+
+    GLCD_Coord.x = 0;
+    GLCD_Coord.y = 0;
+    GLCD_Coord.page = 0xFF; // page register unknown after reset
+
+    GLCD_Inverted = invert ? 0xFF : 0x00;
+
+    GLCD_ClearScreen(WHITE); // display clear, physically black when inverted
+#ifdef GLCD_FRAMEBUFFER
+    /* the panel RAM and registers are unknown, send everything */
+    GLCD_Out.pending = 0; // a run cut short before, maybe on a chip now off
+    for (uint8_t chip = 0; chip < GLCD_CHIP_COUNT; chip++) {
+        GLCD_Out.chipPage[chip] = GLCD_UNKNOWN;
+        GLCD_Out.chipCol[chip] = GLCD_UNKNOWN;
+    }
+#ifdef GLCD_DOUBLE_BUFFER
+    for (uint16_t n = 0; n < sizeof (GLCD_Frame); n++)
+        (&GLCD_Shown[0][0])[n] = ~(&GLCD_Frame[0][0])[n];
+#endif
+    GLCD_FrameDirtyAll();
+    GLCD_Flush();
+#endif
+    GLCD_SetAddress(0, 0);
+    GLCD_PROFILE_EXIT(GLCD_PROF_INIT);
+    return GLCD_Off;
+}
+
+GLCD_API uint8_t GLCD_DoReadData(uint8_t first)
+{
+    uint8_t data, chip;
+
+    chip = GLCD_ChipOf(GLCD_Coord.x);
+    if (first) {
+        if (GLCD_ChipCol(GLCD_Coord.x) == 0 && chip > 0) { // todo , remove this test and call GotoXY always?
+            GLCD_SetAddress(GLCD_Coord.x, GLCD_Coord.y);
+        }
+    }
+
+    data = GLCD_ReadNext(chip);
+
+    if (first == 0)
+        GLCD_SetAddress(GLCD_Coord.x, GLCD_Coord.y);
+    return data;
+}
+
+/*
+ * Reads the byte at the controller's current address. The controller
+ * advances its column address after each read but GLCD_Coord is left
+ * untouched, so consecutive calls return consecutive columns.
+ */
+static uint8_t GLCD_ReadNext(uint8_t chip)
+{
+    GLCD_WaitReady(chip);
+    return GLCD_BusRead(1);
+}
+
+/*
+ * Reads n bytes of a page from column x on into buf, as one sequential read
+ * per chip after its dummy read.
+ */
+static void GLCD_ReadRun(uint8_t page, uint8_t x, uint8_t n, uint8_t *buf)
+{
+#ifdef GLCD_FRAMEBUFFER
+    while (n--)
+        *buf++ = GLCD_Frame[page][x++];
+#else
+    uint8_t chip, k;
+#ifndef GLCD_BUS_RUN
+    uint8_t i;
+#endif
+
+    while (n) {
+        chip = GLCD_ChipOf(x);
+        k = CHIP_WIDTH - GLCD_ChipCol(x);
+        if (k > n)
+            k = n;
+        GLCD_SetAddress(x, page * 8);
+        GLCD_ReadNext(chip); // dummy read, the address is already set
+#ifdef GLCD_BUS_RUN
+        GLCD_WaitReady(chip);
+        GLCD_BusReadRun(buf, k);
+        GLCD_MarkBusy(chip);
+#else
+        for (i = 0; i < k; i++)
+            buf[i] = GLCD_ReadNext(chip);
+#endif
+        x += k;
+        buf += k;
+        n -= k;
+    }
+#endif
+}
+
+#ifdef GLCD_FRAMEBUFFER
+
+GLCD_API void GLCD_WriteData(uint8_t data)
+{
+    uint8_t yOffset, page, x;
+
+    if (GLCD_Coord.x >= DISPLAY_WIDTH)
+        return;
+    page = GLCD_Coord.page;
+    x = GLCD_Coord.x;
+
+    yOffset = GLCD_Coord.y % 8;
+    if (yOffset != 0) {
+        GLCD_FramePut(page, x, GLCD_MergeLow(GLCD_Frame[page][x], data, yOffset));
+        if (page + 1 < DISPLAY_PAGES)
+            GLCD_FramePut(page + 1, x, GLCD_MergeHigh(GLCD_Frame[page + 1][x], data, yOffset));
+    } else {
+        GLCD_FramePut(page, x, data);
+    }
+    GLCD_Coord.x++;
+}
+
+static void GLCD_WriteRun(uint8_t page, uint8_t x, uint8_t last, const uint8_t *data, uint8_t step)
+{
+    if (x > last || GLCD_PastWidth(x))
+        return;
+    GLCD_SetAddress(x, page * 8);
+    for (;;) {
+        GLCD_FramePut(page, x, *data);
+        if (x == last)
+            break;
+        x++;
+        data += step;
+    }
+    GLCD_Coord.x = last + 1;
+}
+
+static uint8_t GLCD_FrameRead(void)
+{
+    if (GLCD_Coord.x >= DISPLAY_WIDTH)
+        return 0;
+    return GLCD_Frame[GLCD_Coord.page][GLCD_Coord.x];
+}
+
+static void GLCD_FramePut(uint8_t page, uint8_t x, uint8_t data)
+{
+    if (GLCD_Frame[page][x] == data)
+        return;
+    GLCD_Frame[page][x] = data;
+
+    GLCD_SERVICE_LOCK();
+    if (x < GLCD_DirtyLo[page])
+        GLCD_DirtyLo[page] = x;
+    if (x > GLCD_DirtyHi[page])
+        GLCD_DirtyHi[page] = x;
+    GLCD_SERVICE_UNLOCK();
+}
+
+static void GLCD_FrameDirtyAll(void)
+{
+    uint8_t page;
+
+    GLCD_SERVICE_LOCK();
+    for (page = 0; page < DISPLAY_PAGES; page++) {
+        GLCD_DirtyLo[page] = 0;
+        GLCD_DirtyHi[page] = DISPLAY_WIDTH - 1;
+    }
+    GLCD_SERVICE_UNLOCK();
+}
+
+#ifdef GLCD_DOUBLE_BUFFER
+/*
+ * Moves GLCD_Out.x[chip] to the next column of the chip to send, from the
+ * first one of its part of the run or after the one just sent, skipping columns
+ * the panel already shows. A gap of up to GLCD_DIFF_GAP unchanged columns is
+ * rewritten since that is cheaper than a new LCD_SET_ADD. Returns 0 at the end.
+ */
+static boolean GLCD_NextChanged(uint8_t chip, boolean first)
+{
+    uint8_t x, start, page = GLCD_Out.page;
+
+    x = GLCD_Out.x[chip];
+    if (!first) {
+        if (x == GLCD_Out.last[chip])
+            return 0;
+        x++;
+    }
+    start = x;
+    while (GLCD_Frame[page][x] == GLCD_Shown[page][x]) {
+        if (x == GLCD_Out.last[chip])
+            return 0;
+        x++;
+    }
+    if (!first && x - start <= GLCD_DIFF_GAP)
+        x = start;
+    GLCD_Out.x[chip] = x;
+    return 1;
+}
+#endif
+
+/*
+ * Picks the next page with changed columns, starting after the page sent
+ * last so a page redrawn continuously can't starve the others, and splits
+ * its run into the part of each chip.
+ */
+static boolean GLCD_NextRun(void)
+{
+    uint8_t i, chip, page, lo, hi;
+
+    page = GLCD_Out.page;
+    for (i = 0; i < DISPLAY_PAGES; i++) {
+        page = (page + 1) % DISPLAY_PAGES;
+
+        GLCD_SERVICE_LOCK();
+        lo = GLCD_DirtyLo[page];
+        hi = GLCD_DirtyHi[page];
+        GLCD_DirtyLo[page] = 0xFF;
+        GLCD_DirtyHi[page] = 0;
+        GLCD_SERVICE_UNLOCK();
+
+        if (lo > hi)
+            continue;
+        GLCD_Out.page = page;
+        for (chip = GLCD_ChipOf(lo); chip <= GLCD_ChipOf(hi); chip++) {
+            if (GLCD_Off & _BV(chip))
+                continue; // still in reset, it would hold up the frame for good
+            GLCD_Out.x[chip] = (chip == GLCD_ChipOf(lo)) ? lo : chip * CHIP_WIDTH;
+            GLCD_Out.last[chip] = (chip == GLCD_ChipOf(hi)) ? hi : chip * CHIP_WIDTH + CHIP_WIDTH - 1;
+#ifdef GLCD_DOUBLE_BUFFER
+            if (!GLCD_NextChanged(chip, 1))
+                continue; // drawn over with the same content
+#endif
+            GLCD_Out.pending |= _BV(chip);
+        }
+        if (GLCD_Out.pending)
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Advances the transfer of the frame to the panel by at most
+ * GLCD_SERVICE_BUDGET bus transfers. The position is kept between calls, so a
+ * run resumes where it stopped, including across chip and page boundaries.
+ * Page and column registers of each chip are tracked so they are only set
+ * when the next byte doesn't follow the last one sent.
+ * When a run spans several chips, the chips take turns, so each one works
+ * through its busy time while the others are written.
+ */
+GLCD_API void GLCD_Service(void)
+{
+    uint8_t budget, chip, col, data;
+
+    GLCD_PROFILE_ENTER();
+    for (budget = GLCD_SERVICE_BUDGET; budget > 0; budget--) {
+        if (!GLCD_Out.pending && !GLCD_NextRun()) {
+            if (GLCD_Out.count.bytes || GLCD_Out.count.commands) {
+                GLCD_LastFrame = GLCD_Out.count;
+                GLCD_Out.count.bytes = 0;
+                GLCD_Out.count.commands = 0;
+            }
+            GLCD_PROFILE_EXIT(GLCD_PROF_SERVICE);
+            return;
+        }
+
+        chip = GLCD_Out.turn;
+        do {
+            chip = (chip + 1) % (GLCD_CHIP_COUNT);
+        } while (!(GLCD_Out.pending & _BV(chip)));
+        col = GLCD_ChipCol(GLCD_Out.x[chip]);
+
+        if (GLCD_ChipIdle(chip))
+            GLCD_SelectChip(chip);
+        else if (GLCD_ReadStatus(chip) & LCD_BUSY_FLAG) {
+            GLCD_PROFILE_EXIT(GLCD_PROF_SERVICE);
+            return; // try again on the next call
+        }
+        GLCD_MarkBusy(chip);
+        GLCD_Out.turn = chip;
+
+        if (GLCD_Out.chipPage[chip] != GLCD_Out.page) {
+            GLCD_BusWrite(0, LCD_SET_PAGE | GLCD_Out.page);
+            GLCD_Out.chipPage[chip] = GLCD_Out.page;
+            GLCD_Out.count.commands++;
+        } else if (GLCD_Out.chipCol[chip] != col) {
+            GLCD_BusWrite(0, LCD_SET_ADD | col);
+            GLCD_Out.chipCol[chip] = col;
+            GLCD_Out.count.commands++;
+        } else {
+            data = GLCD_Frame[GLCD_Out.page][GLCD_Out.x[chip]];
+            GLCD_BusWrite(1, data);
+            GLCD_Out.chipCol[chip] = GLCD_ChipCol(col + 1);
+            GLCD_Out.count.bytes++;
+#ifdef GLCD_DOUBLE_BUFFER
+            GLCD_Shown[GLCD_Out.page][GLCD_Out.x[chip]] = data;
+            if (!GLCD_NextChanged(chip, 0))
+                GLCD_Out.pending &= ~_BV(chip);
+#else
+            if (GLCD_Out.x[chip] == GLCD_Out.last[chip])
+                GLCD_Out.pending &= ~_BV(chip);
+            else
+                GLCD_Out.x[chip]++;
+#endif
+        }
+    }
+    GLCD_PROFILE_EXIT(GLCD_PROF_SERVICE);
+}
+
+GLCD_API boolean GLCD_FrameComplete(void)
+{
+    uint8_t page;
+
+    if (GLCD_Out.pending)
+        return 0;
+    for (page = 0; page < DISPLAY_PAGES; page++) {
+        if (GLCD_DirtyLo[page] <= GLCD_DirtyHi[page])
+            return 0;
+    }
+    return 1;
+}
+
+GLCD_API void GLCD_GetFrameStats(lcdFrameStats *stats)
+{
+    *stats = GLCD_LastFrame;
+}
+
+GLCD_API void GLCD_Flush(void)
+{
+    GLCD_PROFILE_ENTER();
+    while (!GLCD_FrameComplete())
+        GLCD_Service();
+    GLCD_PROFILE_EXIT(GLCD_PROF_FLUSH);
+}
+
+
+#else
+
+#ifdef GLCD_BUS_RUN
+/*
+ * Writes columns x to last of a page, taking data bytes step apart (0 to
+ * repeat one byte), as one bulk transfer per chip. The bus backend takes
+ * care of the busy time between the bytes.
+ */
+static void GLCD_WriteRun(uint8_t page, uint8_t x, uint8_t last, const uint8_t *data, uint8_t step)
+{
+    uint8_t chip, end;
+
+    if (x > last || GLCD_PastWidth(x))
+        return;
+    for (;;) {
+        chip = GLCD_ChipOf(x);
+        end = GLCD_ChipOf(last) == chip ? last : chip * CHIP_WIDTH + CHIP_WIDTH - 1;
+        GLCD_SetAddress(x, page * 8);
+        GLCD_WaitReady(chip);
+        GLCD_BusWriteRun(data, step, end - x + 1);
+        GLCD_MarkBusy(chip);
+        if (end == last)
+            break;
+        data += (uint8_t) (end - x + 1) * step;
+        x = end + 1;
+    }
+    GLCD_Coord.x = last + 1;
+}
+#else
+/*
+ * Writes columns x to last of a page, taking data bytes step apart (0 to
+ * repeat one byte). When the columns span several chips, the chips take
+ * turns byte by byte, so each one works through its busy time while the
+ * others are written, and their column addresses advance in step.
+ */
+static void GLCD_WriteRun(uint8_t page, uint8_t x, uint8_t last, const uint8_t *data, uint8_t step)
+{
+    uint8_t chip, first, k, col, more;
+
+    if (x > last || GLCD_PastWidth(x))
+        return;
+    first = GLCD_ChipOf(x);
+    GLCD_SetAddress(x, page * 8);
+    for (chip = first + 1; chip <= GLCD_ChipOf(last); chip++) {
+        GLCD_WriteCommand(LCD_SET_ADD, chip);
+    }
+
+    for (k = 0, more = 1; more; k++) {
+        more = 0;
+        for (chip = first; chip <= GLCD_ChipOf(last); chip++) {
+            col = (chip == first ? x : chip * CHIP_WIDTH) + k;
+            if (col > last || GLCD_ChipOf(col) != chip)
+                continue;
+            GLCD_WaitReady(chip);
+            GLCD_BusWrite(1, data[(uint8_t) (col - x) * step]);
+            more = 1;
+        }
+    }
+    GLCD_Coord.x = last + 1;
+}
+#endif
+
+GLCD_API void GLCD_WriteData(uint8_t data)
+{
+    uint8_t displayData, yOffset, chip;
+    //showHex("wrData",data);
+    //showXY("wr", GLCD_Coord.x,GLCD_Coord.y);
+
+#ifdef GLCD_DEBUG
+    volatile uint16_t i;
+    for (i = 0; i < 5000; i++);
+#endif
+
+    if (GLCD_Coord.x >= DISPLAY_WIDTH)
+        return;
+    chip = GLCD_ChipOf(GLCD_Coord.x);
+
+    if (GLCD_ChipCol(GLCD_Coord.x) == 0 && chip > 0) { // todo , ignore address 0???
+        GLCD_SetAddress(GLCD_Coord.x, GLCD_Coord.y);
+    }
+    GLCD_WaitReady(chip); // also after GotoXY, the delays no longer cover the busy time
+
+    yOffset = GLCD_Coord.y % 8;
+
+    if (yOffset != 0) {
+        // first page
+        GLCD_ReadData(displayData);
+        GLCD_WaitReady(chip);
+
+        displayData = GLCD_MergeLow(displayData, data, yOffset);
+        GLCD_BusWrite(1, displayData); // write data
+
+        // second page, unless the first one is the bottom page
+        if (GLCD_Coord.y + 8 < DISPLAY_HEIGHT) {
+            GLCD_SetAddress(GLCD_Coord.x, GLCD_Coord.y + 8);
+
+            GLCD_ReadData(displayData);
+            GLCD_WaitReady(chip);
+
+            displayData = GLCD_MergeHigh(displayData, data, yOffset);
+            GLCD_BusWrite(1, displayData); // write data
+            GLCD_Coord.y -= 8;
+        }
+
+        /*
+         * GotoXY ignores an x past the last column, which would leave the
+         * next call writing over this column again
+         */
+        GLCD_Coord.x++;
+        if (GLCD_Coord.x < DISPLAY_WIDTH)
+            GLCD_SetAddress(GLCD_Coord.x, GLCD_Coord.y);
+    } else {
+        // just this code gets executed if the write is on a single page
+        GLCD_BusWrite(1, data); // write data
+        GLCD_Coord.x++;
+        //showXY("WrData",GLCD_Coord.x, GLCD_Coord.y);
+    }
+}
+
+#endif
+
+/*
+ * Writes count bytes to a page from column x on, one per column, as page
+ * runs. Bytes are in drawing colors like GLCD_WriteData(), the inversion is
+ * applied here. Columns past the right edge are dropped.
+ */
+GLCD_API void GLCD_WritePage(uint8_t x, uint8_t page, const uint8_t *data, uint8_t count)
+{
+    uint8_t buf[GLCD_INVERT_CHUNK];
+    uint8_t i, n;
+
+    if (GLCD_PastWidth(x) || count == 0)
+        return;
+    if (count > DISPLAY_WIDTH - x)
+        count = DISPLAY_WIDTH - x;
+    if (!GLCD_Inverted) {
+        GLCD_WriteRun(page, x, x + count - 1, data, 1);
+        return;
+    }
+    while (count) {
+        n = count < GLCD_INVERT_CHUNK ? count : GLCD_INVERT_CHUNK;
+        for (i = 0; i < n; i++)
+            buf[i] = ~data[i];
+        GLCD_WriteRun(page, x, x + n - 1, buf, 1);
+        x += n;
+        data += n;
+        count -= n;
+    }
+}
+
+GLCD_API void GLCD_DrawBitmap(const uint8_t * bitmap, uint8_t x, uint8_t y, uint8_t color)
+{
+    uint8_t width, height;
+    uint8_t i, j;
+
+    GLCD_PROFILE_ENTER();
+    color = ~(color ^ GLCD_Inverted); /* XOR mask for the bitmap data */
+    width = ReadPgmData(bitmap++);
+    height = ReadPgmData(bitmap++);
+    if (GLCD_Rotation) {
+        GLCD_DrawRotated(GLCD_PgmSource, &bitmap, x, y, width, height & ~7, width, height & ~7, color);
+        GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_BITMAP);
+        return;
+    }
+    /* GotoXY ignores a y past the bottom, the rows there would land in the last page */
+    for (j = 0; j < height / 8 && y + j * 8 < DISPLAY_HEIGHT; j++) {
+        GLCD_SetAddress(x, y + (j * 8));
+        for (i = 0; i < width; i++) {
+            uint8_t displayData = ReadPgmData(bitmap++);
+            GLCD_WriteData(displayData ^ color);
+        }
+    }
+    GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_BITMAP);
+}
+
+/*
+ * DrawBitmap with the data pulled from read(source) a chunk at a time, in
+ * the same layout: width, height, then the bytes page by page and column by
+ * column. Each chunk goes from the buffer straight to the panel, so a
+ * bitmap in external flash needs no RAM copy. Columns past the right edge
+ * are read and dropped, nothing is read past the bottom edge.
+ */
+GLCD_API void GLCD_DrawBitmapStream(BitmapCallback read, void *source, uint8_t x, uint8_t y, uint8_t color)
+{
+    uint8_t buf[GLCD_STREAM_CHUNK];
+    uint8_t width, height, i, j, k, n, shown;
+
+    GLCD_PROFILE_ENTER();
+    color = ~(color ^ GLCD_Inverted); /* XOR mask for the bitmap data */
+    if (read(source, buf, 2) != 2) {
+        GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_BITMAP_STREAM);
+        return;
+    }
+    width = buf[0];
+    height = buf[1];
+    if (GLCD_Rotation) {
+        GLCD_DrawRotated(read, source, x, y, width, height & ~7, width, height & ~7, color);
+        GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_BITMAP_STREAM);
+        return;
+    }
+
+    for (j = 0; j < height / 8 && y + j * 8 < DISPLAY_HEIGHT; j++) {
+        GLCD_SetAddress(x, y + j * 8);
+        for (i = 0; i < width; i += n) {
+            n = width - i < GLCD_STREAM_CHUNK ? width - i : GLCD_STREAM_CHUNK;
+            if (read(source, buf, n) != n) {
+                GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_BITMAP_STREAM);
+                return;
+            }
+            if (x + i > DISPLAY_WIDTH - 1)
+                continue;
+            shown = x + i + n > DISPLAY_WIDTH ? DISPLAY_WIDTH - x - i : n;
+            for (k = 0; k < shown; k++)
+                GLCD_WriteData(buf[k] ^ color);
+        }
+    }
+    GLCD_PROFILE_EXIT(GLCD_PROF_DRAW_BITMAP_STREAM);
+}
@@ -0,0 +1,93 @@
+/*
+  GLCD_Dither.h - grayscale images for the PIC GLCD library
+
+  Converts 8 bit grayscale scanlines, 0 black to 255 white, into the page
+  bytes of the panel while they arrive. Each row is dithered and packed into
+  a one page band, and every completed band of 8 rows is written to the panel
+  as page runs, so a whole image never has to be held in RAM.
+
+  A gray layer shows 4 levels in a page aligned area by alternating two bit
+  planes on the panel, see lcdGray.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef GLCD_DITHER_H
+#define GLCD_DITHER_H
+
+#include "GLCD.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A dithered image in columns x to x + width - 1 from page down. band holds
+ * width bytes. error is NULL for 8 x 8 Bayer ordered dithering, or width + 1
+ * entries for Floyd-Steinberg error diffusion, which keeps more detail but
+ * takes more work per pixel and the error row in RAM. width is 8 bit, so a
+ * dither covers at most 255 columns; a wider image takes two side by side.
+ */
+typedef struct {
+    uint8_t x, page, width;
+    uint8_t row;                    // rows packed into the band
+    uint8_t *band;
+    int16_t *error;                 // error for the next row, shifted by one
+} lcdDither;
+
+// Gray layer levels, the share of the time a pixel is black
+#define GLCD_GRAY_WHITE 0
+#define GLCD_GRAY_LIGHT 1
+#define GLCD_GRAY_DARK  2
+#define GLCD_GRAY_BLACK 3
+
+/*
+ * Columns of equal bytes between two changed runs that GLCD_GrayTick() writes
+ * anyway instead of setting the address again, which takes two commands.
+ */
+#ifndef GLCD_GRAY_GAP
+#define GLCD_GRAY_GAP 2
+#endif
+
+/*
+ * Gray layer over columns x to x + width - 1 and pages page to page + pages - 1.
+ * planes holds 2 * width * pages bytes, the high bit of each level then the
+ * low bit, page by page in panel layout.
+ *
+ * GLCD_GrayTick() must be called at a fixed rate, 150 Hz or so. It shows the
+ * high plane for two ticks and the low plane for one, so a pixel is black
+ * level / 3 of the time. Only the first tick of each plane writes to the
+ * panel, and then only the bytes that differ between the planes, plus the
+ * columns drawn into since the last tick. Other drawing may go on outside the
+ * layer as usual. A layer covers at most 255 columns.
+ *
+ * The tick draws like any other call: it moves the panel address and the
+ * current position, and takes the dirty columns the GLCD_Gray functions mark.
+ * Call it from the main loop, between drawing calls, when a timer interrupt
+ * has set a flag, not from the interrupt itself.
+ */
+typedef struct {
+    uint8_t x, page, width, pages;
+    uint8_t *planes;
+    uint8_t phase;                  // tick of the 3 tick cycle
+    uint8_t shown;                  // plane on the panel, 0 high, 1 low
+    uint8_t dirtyLo, dirtyHi;       // columns drawn into, none if Lo > Hi
+    uint16_t bytes;                 // data bytes written by the last tick
+} lcdGray;
+
+void GLCD_DitherInit(lcdDither *dither, uint8_t x, uint8_t page, uint8_t width, uint8_t *band, int16_t *error);
+void GLCD_DitherRow(lcdDither *dither, const uint8_t *gray);
+void GLCD_DitherEnd(lcdDither *dither);    // writes a last band of fewer than 8 rows
+
+void GLCD_GrayInit(lcdGray *gray, uint8_t x, uint8_t page, uint8_t width, uint8_t pages, uint8_t *planes);
+void GLCD_GraySetDot(lcdGray *gray, uint8_t x, uint8_t y, uint8_t level);
+void GLCD_GrayFillRect(lcdGray *gray, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t level);
+void GLCD_GrayTick(lcdGray *gray);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
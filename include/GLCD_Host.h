@@ -0,0 +1,116 @@
+/*
+  GLCD_Host.h - Host (PC) emulation of a ks0108 panel for the PIC GLCD library
+
+  Building the library with GLCD_HOST defined maps the pins in GLCD_Pins.h
+  onto an emulated ks0108 panel, so the unmodified driver code can run on a
+  PC. The emulator follows the bus protocol at pin level: commands and data
+  are latched on the falling edge of EN, reads are driven while EN is high,
+  and each chip stays busy for GLCD_HOST_BUSY_NS after an access.
+
+  With GLCD_BUS_SPI the pins drive two emulated 74HC595 (control register
+  first in the chain) and a 74HC165 reading the data lines back. With
+  GLCD_BUS_MEMORY the library calls the GLCD_HostBusXxx() functions instead
+  of driving pins, and each access takes GLCD_T_CYC.
+
+  Time is simulated. Every pin access costs one PIC instruction cycle at
+  _XTAL_FREQ and the __delay_xx() macros advance the clock by their
+  argument, so GLCD_HostTime() gives the time the same code would take on
+  the target.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <stdint.h>
+
+#ifndef GLCD_HOST_H
+#define GLCD_HOST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _XTAL_FREQ
+#define _XTAL_FREQ 64000000UL   // emulated PIC oscillator frequency
+#endif
+
+#ifndef GLCD_HOST_BUSY_NS
+#define GLCD_HOST_BUSY_NS   3000    // busy time after each access (3/fCLK at 1 MHz)
+#endif
+
+#ifndef GLCD_HOST_RESET_NS
+#define GLCD_HOST_RESET_NS  1000000 // time the reset flag stays set after RST goes high
+#endif
+
+// emulated panels, follow the geometry in GLCD.h and sit side by side
+#define GLCD_HOST_CHIPS     GLCD_CS_LINES
+#define GLCD_HOST_PAGES     DISPLAY_PAGES
+#define GLCD_HOST_COLUMNS   CHIP_WIDTH
+
+/* Bus and timing statistics, cleared by GLCD_HostResetStats() */
+typedef struct {
+    uint32_t commands;      // instructions written (D/I = 0)
+    uint32_t writes;        // display data bytes written
+    uint32_t reads;         // display data bytes read, dummy reads included
+    uint32_t polls;         // status reads
+    uint32_t violations;    // accesses while busy, EN high or low for less than 450 ns
+    uint64_t time;          // simulated time in picoseconds since the last reset
+} GLCD_HostStats;
+
+/* Pin and port latches driven by the library */
+typedef struct {
+    uint8_t cs[4];      // CSEL1..CSEL4
+    uint8_t csa0, csa1; // decoder address, GLCD_CS_DECODER
+    uint8_t r_w, d_i, en, rst;
+    uint8_t dout, tris;
+    uint8_t latch, load, doe;   // shift register lines, GLCD_BUS_SPI
+} GLCD_HostPinState;
+
+#ifdef GLCD_CONTEXTS
+#define GLCD_TLS __thread   // each thread gets its own emulator and current context
+#else
+#define GLCD_TLS
+#endif
+
+extern GLCD_TLS GLCD_HostPinState GLCD_HostPins;
+
+// Pin access hooks used by GLCD_Pins.h
+volatile uint8_t *GLCD_HostPin(volatile uint8_t *pin);
+uint8_t GLCD_HostReadPort(void);
+void GLCD_HostDelay(uint32_t ns);
+uint16_t GLCD_HostTimer(void);  // free running instruction cycle counter
+uint8_t GLCD_HostSpiXfer(uint8_t out);  // one SPI byte, GLCD_BUS_SPI
+
+// Bus level access to the controllers, GLCD_BUS_MEMORY
+void GLCD_HostBusSelect(uint8_t chip);
+uint8_t GLCD_HostBusRead(uint8_t di);
+void GLCD_HostBusWrite(uint8_t di, uint8_t value);
+void GLCD_HostBusWriteRun(const uint8_t *data, uint8_t step, uint8_t n);
+void GLCD_HostBusReadRun(uint8_t *buf, uint8_t n);
+
+#define __delay_us(us)  GLCD_HostDelay((uint32_t)(us) * 1000UL)
+#define __delay_ms(ms)  GLCD_HostDelay((uint32_t)(ms) * 1000000UL)
+#define _delay(cycles)  GLCD_HostDelay((uint32_t)(((uint64_t)(cycles) * 4000000000ULL) / _XTAL_FREQ))
+
+/*
+ * Bus transaction kinds passed to a GLCD_HostTraceFn: 'C' command, 'W' data
+ * write, 'R' data read, 'S' status read. chip is the chip select line.
+ */
+typedef void (*GLCD_HostTraceFn)(uint8_t chip, char kind, uint8_t value);
+
+// Emulator control and inspection
+void GLCD_HostPowerOn(void);
+void GLCD_HostHoldReset(uint8_t chips);     // chips that never leave reset, until the next power on
+void GLCD_HostResetStats(void);
+const GLCD_HostStats *GLCD_HostGetStats(void);
+uint64_t GLCD_HostTime(void);               // picoseconds since power on
+uint8_t GLCD_HostPixel(uint16_t x, uint8_t y);  // pixel as shown, panel n from n * DISPLAY_WIDTH
+uint8_t GLCD_HostByte(uint16_t x, uint8_t page); // raw display RAM byte
+void GLCD_HostTrace(GLCD_HostTraceFn fn);   // called for every transaction, NULL to stop
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
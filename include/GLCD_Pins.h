@@ -13,6 +13,10 @@
 
 #define CSEL1	LATBbits.LATB0		// CS1 Bit   // swap pin assignments with CSEL2 if left/right image is reversed
 #define CSEL2	LATBbits.LATB1		// CS2 Bit
+// #define CSEL3	LATBbits.LATB6		// CS3 Bit, panels with 3 or 4 chips
+// #define CSEL4	LATBbits.LATB7		// CS4 Bit
+// #define CSA0	LATBbits.LATB0		// decoder address bits, GLCD_CS_DECODER
+// #define CSA1	LATBbits.LATB1
 
 #define R_W	LATBbits.LATB3		// R/W Bit
 #define D_I	LATBbits.LATB2		// D/I Bit
@@ -23,10 +27,25 @@
 #define GLCD_DIN_REG    PORTD
 #define GLCD_DDIR_REG   TRISD
 
+// GLCD_BUS_SPI: 74HC595/74HC165 on MSSP1 (SCK RC3, SDI RC4, SDO RC5), EN as above
+// #define GLCD_SPI_LATCH  LATCbits.LATC0      // 74HC595 RCLK
+// #define GLCD_SPI_LOAD   LATCbits.LATC1      // 74HC165 SH/LD
+// #define GLCD_SPI_DOE    LATCbits.LATC2      // data 74HC595 /OE
+// #define GLCD_SPI_BUF    SSP1BUF
+// #define GLCD_SPI_DONE() SSP1STATbits.BF
+
+// free running timer for GLCD_BUSY_ELISION, Timer1 clocked from Fosc/4
+#define GLCD_TIMER()            TMR1
+#define GLCD_TIMER_PRESCALE     1
+
 #elif defined (__PICC__)
 
 #define CSEL1	PORTBbits.RB0		// CS1 Bit   // swap pin assignments with CSEL2 if left/right image is reversed
 #define CSEL2	PORTBbits.RB1		// CS2 Bit
+// #define CSEL3	PORTBbits.RB6		// CS3 Bit, panels with 3 or 4 chips
+// #define CSEL4	PORTBbits.RB7		// CS4 Bit
+// #define CSA0	PORTBbits.RB0		// decoder address bits, GLCD_CS_DECODER
+// #define CSA1	PORTBbits.RB1
 
 #define R_W	PORTBbits.RB3		// R/W Bit
 #define D_I	PORTBbits.RB2		// D/I Bit
@@ -37,6 +56,41 @@
 #define GLCD_DIN_REG    PORTD
 #define GLCD_DDIR_REG   TRISD
 
+// free running timer for GLCD_BUSY_ELISION, Timer1 clocked from Fosc/4
+#define GLCD_TIMER()            TMR1
+#define GLCD_TIMER_PRESCALE     1
+
+#elif defined (GLCD_HOST)
+
+#include "GLCD_Host.h"   // pins drive the emulated panel, see GLCD_Host.h
+
+#define CSEL1	(*GLCD_HostPin(&GLCD_HostPins.cs[0]))
+#define CSEL2	(*GLCD_HostPin(&GLCD_HostPins.cs[1]))
+#define CSEL3	(*GLCD_HostPin(&GLCD_HostPins.cs[2]))
+#define CSEL4	(*GLCD_HostPin(&GLCD_HostPins.cs[3]))
+#define CSA0	(*GLCD_HostPin(&GLCD_HostPins.csa0))
+#define CSA1	(*GLCD_HostPin(&GLCD_HostPins.csa1))
+
+#define R_W	(*GLCD_HostPin(&GLCD_HostPins.r_w))
+#define D_I	(*GLCD_HostPin(&GLCD_HostPins.d_i))
+#define EN	(*GLCD_HostPin(&GLCD_HostPins.en))
+#define RST 	(*GLCD_HostPin(&GLCD_HostPins.rst))
+
+#define GLCD_DOUT_REG   (*GLCD_HostPin(&GLCD_HostPins.dout))
+#define GLCD_DIN_REG    GLCD_HostReadPort()
+#define GLCD_DDIR_REG   (*GLCD_HostPin(&GLCD_HostPins.tris))
+
+#define GLCD_SPI_LATCH  (*GLCD_HostPin(&GLCD_HostPins.latch))
+#define GLCD_SPI_LOAD   (*GLCD_HostPin(&GLCD_HostPins.load))
+#define GLCD_SPI_DOE    (*GLCD_HostPin(&GLCD_HostPins.doe))
+#define GLCD_SPI_XFER(b) GLCD_HostSpiXfer(b)
+
+#define GLCD_TIMER()            GLCD_HostTimer()    // instruction cycles
+#define GLCD_TIMER_PRESCALE     1
+// emulated instruction cycles, only the bus accesses and delays take time
+#define GLCD_PROFILE_TIMER()    ((uint32_t) (GLCD_HostTime() / (4000000000000ULL / _XTAL_FREQ)))
+#define GLCD_PROFILE_TICK       uint32_t
+
 #else
 #error "Please define GLCD pin mapping for your platform."
 #endif
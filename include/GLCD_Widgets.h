@@ -0,0 +1,132 @@
+/*
+  GLCD_Widgets.h - bar, level meter, gauge, chart and big number widgets for the PIC GLCD library
+
+  Each widget remembers what it shows, so an update only redraws the part
+  between the old and the new value instead of clearing and filling the
+  whole widget. Frames and scales are drawn once, by the init function.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef GLCD_WIDGETS_H
+#define GLCD_WIDGETS_H
+
+#include "GLCD.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Widget flags
+#define GLCD_WIDGET_VERTICAL    0x01    // fills from the bottom up
+#define GLCD_WIDGET_ROUND       0x02    // rounded frame
+#define GLCD_WIDGET_SIGNED      0x04    // big number: a cell for the minus sign
+#define GLCD_WIDGET_ZEROS       0x08    // big number: leading zeros instead of blanks
+
+// Gap between level meter segments
+#ifndef GLCD_LEVEL_GAP
+#define GLCD_LEVEL_GAP  2
+#endif
+
+// Needle positions of a gauge over its half circle
+#define GLCD_GAUGE_STEPS    64
+
+// Most digits of a big number, and the columns between two of them
+#ifndef GLCD_BIGNUM_MAX
+#define GLCD_BIGNUM_MAX 6
+#endif
+#ifndef GLCD_BIGNUM_GAP
+#define GLCD_BIGNUM_GAP 2
+#endif
+
+/*
+ * Bar graph or progress bar. The frame takes x to x + width and y to
+ * y + height like GLCD_DrawRect(), the bar fills its inside less a one pixel
+ * margin. Updates are plain page writes when the inside rows y + 2 to
+ * y + height - 2 start and end on page boundaries, e.g. y = 6 and
+ * height = 11 for rows 8 to 15.
+ */
+typedef struct {
+    uint8_t x, y, width, height;    // inside of the bar
+    uint8_t flags;
+    uint8_t fill;                   // pixels filled on the display
+} lcdBar;
+
+/* Segmented level meter, GLCD_WIDGET_VERTICAL meters light from the bottom up */
+typedef struct {
+    uint8_t x, y, width, height;
+    uint8_t flags;
+    uint8_t segments;
+    uint8_t pitch;                  // segment length plus GLCD_LEVEL_GAP
+    uint8_t lit;                    // segments lit on the display
+} lcdLevel;
+
+/* Half circle gauge with a needle, value 0 points left and max right */
+typedef struct {
+    uint8_t cx, cy, radius;
+    uint8_t step;                   // needle position on the display
+} lcdGauge;
+
+/*
+ * Rolling strip chart over whole pages: columns x to x + width - 1, pages
+ * page to page + pages - 1. The ring holds the lowest and highest row each
+ * column covers (2 * width bytes, supplied by the caller), samples fill the
+ * chart from the left and then scroll it left by one column each.
+ *
+ * Every column byte is rasterized from the ring with the gridlines ORed in,
+ * so a scroll is one write per column and page and no reads: 400 bytes for a
+ * 100 x 32 chart. gridRows puts a dotted line every gridRows rows from the
+ * bottom, gridCols a dotted line every gridCols samples that scrolls with
+ * the trace, 0 leaves them out. A chart covers at most 255 columns.
+ */
+typedef struct {
+    uint8_t x, page, width, pages;
+    uint8_t *ring;                  // lowest and highest row per column, 0 is the bottom
+    uint8_t head;                   // ring slot of the leftmost column once full
+    uint8_t count;                  // columns filled
+    uint8_t last;                   // row of the previous sample
+    uint8_t gridRows, gridCols;
+    uint8_t phase;                  // sample number of the leftmost column, mod gridCols
+} lcdChart;
+
+/*
+ * Large seven segment number over whole pages, from column x and page page
+ * down, pages * 8 rows tall (3 for 24 rows, 4 for 32). A digit is
+ * pages * 4 + 2 columns wide and its strokes pages thick. The value is an
+ * integer with decimals digits after the decimal point, which stays put,
+ * and it is right aligned in digits cells, plus one more on the left for
+ * the sign with GLCD_WIDGET_SIGNED. A value that doesn't fit shows dashes.
+ *
+ * Digits are composed column by column into page bytes and written as page
+ * runs, without reads, and only the cells whose character changed are
+ * written again.
+ */
+typedef struct {
+    uint8_t x, page, pages;
+    uint8_t digits, decimals, flags;
+    uint8_t width;                  // columns of a digit
+    char shown[GLCD_BIGNUM_MAX + 1]; // characters of the cells on the display
+} lcdBigNum;
+
+void GLCD_BarInit(lcdBar *bar, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t flags);
+void GLCD_BarSet(lcdBar *bar, uint16_t value, uint16_t max);
+
+void GLCD_LevelInit(lcdLevel *level, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t segments, uint8_t flags);
+void GLCD_LevelSet(lcdLevel *level, uint16_t value, uint16_t max);
+
+void GLCD_GaugeInit(lcdGauge *gauge, uint8_t cx, uint8_t cy, uint8_t radius);
+void GLCD_GaugeSet(lcdGauge *gauge, uint16_t value, uint16_t max);
+
+void GLCD_ChartInit(lcdChart *chart, uint8_t x, uint8_t page, uint8_t width, uint8_t pages, uint8_t *ring, uint8_t gridRows, uint8_t gridCols);
+void GLCD_ChartAdd(lcdChart *chart, uint16_t value, uint16_t max);
+
+void GLCD_BigNumInit(lcdBigNum *num, uint8_t x, uint8_t page, uint8_t pages, uint8_t digits, uint8_t decimals, uint8_t flags);
+void GLCD_BigNumSet(lcdBigNum *num, int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
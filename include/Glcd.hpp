@@ -0,0 +1,462 @@
+/*
+  Glcd.hpp - C++ interface to the PIC GLCD library for ks0108 graphic LCDs
+
+  Header only. Glcd<Bus, Geometry, FontReader, Invertible> compiles the
+  drawing algorithms of GLCD_Core.h, the same ones GLCD.c is built from, as
+  static members of the class, with the bus, the panel size, the font reader
+  and inversion support bound to its template parameters. Every pin access,
+  panel dimension and font read is a constant the compiler can inline, and
+  without Invertible the inversion mask folds away.
+
+    typedef glcd::ParallelBus<
+        glcd::ChipSelect<glcd::Pin<LATB, 0>, glcd::Pin<LATB, 1> >,
+        glcd::Pin<LATB, 2>,     // D/I
+        glcd::Pin<LATB, 3>,     // R/W
+        glcd::Pin<LATB, 4>,     // EN
+        glcd::Pin<LATB, 5>,     // RST, glcd::NoPin if not connected
+        glcd::Port<LATD, PORTD, TRISD> > Bus;
+
+    glcd::Glcd<Bus> lcd;
+    lcd.init(NON_INVERTED);
+    lcd.selectFont(System5x7);
+    lcd.puts("Hello");
+
+  The display state is static, one per instantiation, so two panels take two
+  Bus types. The bus timing comes from GLCD.h and _XTAL_FREQ, and the frame
+  buffer and busy elision options of GLCD.h apply as for C.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef GLCD_HPP
+#define GLCD_HPP
+
+#include <stdint.h>
+#ifndef GLCD_HOST
+#include <xc.h>
+#endif
+
+#include "GLCD.h"
+
+namespace glcd {
+
+/*
+ * Pins
+ */
+
+// One bit of a port latch, e.g. Pin<LATB, 4>
+template <volatile uint8_t &Reg, uint8_t Bit>
+struct Pin {
+    static void write(uint8_t v)
+    {
+        if (v)
+            Reg |= (uint8_t) (1 << Bit);
+        else
+            Reg &= (uint8_t) ~(1 << Bit);
+    }
+};
+
+// Unconnected pin, e.g. no RST line
+struct NoPin {
+    static void write(uint8_t) { }
+};
+
+// 8 bit data port: output latch, input port and direction register
+template <volatile uint8_t &Lat, volatile uint8_t &In, volatile uint8_t &Tris>
+struct Port {
+    static void write(uint8_t v) { Lat = v; }
+    static uint8_t read() { return In; }
+    static void input() { Tris = 0xFF; }
+    static void output() { Tris = 0x00; }
+};
+
+// One chip select line per chip, at Active for the selected chip
+template <class Cs1, class Cs2 = NoPin, class Cs3 = NoPin, class Cs4 = NoPin, uint8_t Active = GLCD_CS_ACTIVE>
+struct ChipSelect {
+    static void select(uint8_t chip)
+    {
+        Cs1::write(chip == 0 ? Active : !Active);
+        Cs2::write(chip == 1 ? Active : !Active);
+        Cs3::write(chip == 2 ? Active : !Active);
+        Cs4::write(chip == 3 ? Active : !Active);
+    }
+};
+
+// Chip selects from a 2-to-4 decoder
+template <class A0, class A1>
+struct DecoderSelect {
+    static void select(uint8_t chip)
+    {
+        A0::write(chip & 1);
+        A1::write((chip >> 1) & 1);
+    }
+};
+
+/*
+ * ks0108 parallel bus, the GLCD_Bus* primitives of GLCD.c. Anything with the
+ * same static functions can be plugged into Glcd.
+ */
+template <class Cs, class Di, class Rw, class En, class Rst, class Data>
+struct ParallelBus {
+    // addresses chip for the accesses that follow
+    static void select(uint8_t chip) { Cs::select(chip); }
+
+    // idle state of the lines
+    static void init()
+    {
+        Di::write(0);
+        Rw::write(0);
+        En::write(0);
+    }
+
+    static void reset()
+    {
+        Rst::write(0);
+        RST_DELAY();
+        Rst::write(1);
+    }
+
+    // waits until the selected chip clears its busy flag
+    static void poll()
+    {
+        Data::input();
+        Di::write(0);
+        Rw::write(1);
+        SETUP_DELAY();
+        En::write(1);
+        EN_DELAY();
+        while (Data::read() & LCD_BUSY_FLAG)
+            ;
+        En::write(0);
+        EN_LOW_DELAY();
+    }
+
+    // reads the data (di = 1) or status (di = 0) register of the selected chip
+    static uint8_t read(uint8_t di)
+    {
+        uint8_t data;
+
+        Data::input();
+        Di::write(di);
+        Rw::write(1);
+        SETUP_DELAY();
+        En::write(1);
+        EN_DELAY();
+        data = Data::read();
+        En::write(0);
+        EN_LOW_DELAY();
+        return data;
+    }
+
+    // writes a data (di = 1) or command (di = 0) byte to the selected chip
+    static void write(uint8_t di, uint8_t value)
+    {
+        Di::write(di);
+        Rw::write(0);
+        Data::output();
+        Data::write(value);
+        SETUP_DELAY();
+        En::write(1);
+        EN_DELAY();
+        En::write(0);
+        EN_LOW_DELAY();
+    }
+};
+
+#ifdef GLCD_HOST
+/*
+ * Pins of the host emulator (GLCD_Host.h)
+ */
+template <uint8_t GLCD_HostPinState::*Member>
+struct HostPin {
+    static void write(uint8_t v) { *GLCD_HostPin(&(GLCD_HostPins.*Member)) = v; }
+};
+
+template <uint8_t N>
+struct HostCsPin {
+    static void write(uint8_t v) { *GLCD_HostPin(&GLCD_HostPins.cs[N]) = v; }
+};
+
+struct HostData {
+    static void write(uint8_t v) { *GLCD_HostPin(&GLCD_HostPins.dout) = v; }
+    static uint8_t read() { return GLCD_HostReadPort(); }
+    static void input() { *GLCD_HostPin(&GLCD_HostPins.tris) = 0xFF; }
+    static void output() { *GLCD_HostPin(&GLCD_HostPins.tris) = 0x00; }
+};
+
+#ifdef GLCD_CS_DECODER
+typedef DecoderSelect<HostPin<&GLCD_HostPinState::csa0>, HostPin<&GLCD_HostPinState::csa1> > HostSelect;
+#else
+typedef ChipSelect<HostCsPin<0>, HostCsPin<1>, HostCsPin<2>, HostCsPin<3> > HostSelect;
+#endif
+
+typedef ParallelBus<HostSelect,
+        HostPin<&GLCD_HostPinState::d_i>,
+        HostPin<&GLCD_HostPinState::r_w>,
+        HostPin<&GLCD_HostPinState::en>,
+        HostPin<&GLCD_HostPinState::rst>,
+        HostData> HostBus;
+#endif
+
+/*
+ * Panel geometry
+ */
+template <uint16_t Width = 128, uint8_t Height = 64, uint8_t ChipWidth = 64>
+struct Geometry {
+    static const uint16_t width = Width;
+    static const uint8_t height = Height;
+    static const uint8_t pages = Height / 8;
+    static const uint8_t chipWidth = ChipWidth;
+    static const uint8_t chips = Width / ChipWidth;
+
+    static_assert(Width <= 256 && Width % ChipWidth == 0 && chips <= 4, "up to 4 chips and 256 columns");
+};
+
+/*
+ * Font readers
+ */
+
+// fonts in directly addressable memory, like ReadPgmData()
+struct PgmRead {
+    static uint8_t read(const uint8_t *p) { return *p; }
+};
+
+// wraps a FontCallback known at compile time
+template <FontCallback F>
+struct CallbackRead {
+    static uint8_t read(const uint8_t *p) { return F(p); }
+};
+
+/*
+ * Display state, the fields of lcdContext (GLCD.h) sized for a Geometry
+ */
+template <bool Wide> struct ColumnType { typedef uint8_t type; };
+template <> struct ColumnType<true> { typedef uint16_t type; };
+
+// inversion mask, a constant 0 when inversion isn't supported
+template <bool Invertible> struct Inversion {
+    uint8_t mask;
+    operator uint8_t() const { return mask; }
+    Inversion &operator=(uint8_t m) { mask = m; return *this; }
+};
+template <> struct Inversion<false> {
+    operator uint8_t() const { return 0; }
+    Inversion &operator=(uint8_t) { return *this; }
+};
+
+template <class Geom>
+struct Coord {
+    typename ColumnType<(Geom::width > 255)>::type x;
+    uint8_t y;
+    uint8_t page;
+};
+
+template <class Geom>
+struct FrameOut {
+    uint8_t page;
+    uint8_t pending;
+    uint8_t turn;
+    uint8_t x[Geom::chips];
+    uint8_t last[Geom::chips];
+    uint8_t chipPage[Geom::chips];
+    uint8_t chipCol[Geom::chips];
+    lcdFrameStats count;
+};
+
+template <class Geom, bool Invertible>
+struct Context {
+    uint8_t panel;
+    uint8_t off;
+    Coord<Geom> coord;
+    Inversion<Invertible> inverted;
+    uint8_t fontColor;
+    const uint8_t *font;
+    uint8_t rotation;
+    lcdPoint cursor;
+#ifdef GLCD_BUSY_ELISION
+    uint16_t readyAt[Geom::chips];
+#endif
+#ifdef GLCD_FRAMEBUFFER
+    uint8_t frame[Geom::pages][Geom::width];
+    uint8_t dirtyLo[Geom::pages];
+    uint8_t dirtyHi[Geom::pages];
+#ifdef GLCD_DOUBLE_BUFFER
+    uint8_t shown[Geom::pages][Geom::width];
+#endif
+    FrameOut<Geom> out;
+    lcdFrameStats lastFrame;
+#endif
+};
+
+/*
+ * What GLCD.c defines around GLCD_Core.h, bound to the template parameters.
+ * The previous definitions are restored after the class.
+ */
+#pragma push_macro("DISPLAY_WIDTH")
+#pragma push_macro("DISPLAY_HEIGHT")
+#pragma push_macro("DISPLAY_PAGES")
+#pragma push_macro("CHIP_WIDTH")
+#pragma push_macro("GLCD_CHIP_COUNT")
+#pragma push_macro("_BV")
+#undef DISPLAY_WIDTH
+#undef DISPLAY_HEIGHT
+#undef DISPLAY_PAGES
+#undef CHIP_WIDTH
+#undef GLCD_CHIP_COUNT
+#undef _BV
+#define DISPLAY_WIDTH   ((int) Geom::width)
+#define DISPLAY_HEIGHT  ((int) Geom::height)
+#define DISPLAY_PAGES   ((int) Geom::pages)
+#define CHIP_WIDTH      ((int) Geom::chipWidth)
+#define GLCD_CHIP_COUNT ((int) Geom::chips)
+#define _BV(i) (1 << (i))
+
+#define GLCD_PastWidth(x) (DISPLAY_WIDTH < 256 && (x) > DISPLAY_WIDTH - 1)
+#define GLCD_ChipOf(x)  ((x) / CHIP_WIDTH)
+#define GLCD_ChipCol(x) ((x) % CHIP_WIDTH)
+
+#define GLCD_SelectChip(chip) Bus::select(chip)
+#define GLCD_BusInit() Bus::init()
+#define GLCD_BusReset() Bus::reset()
+#define GLCD_BusPoll() Bus::poll()
+#define GLCD_BusRead(di) Bus::read(di)
+#define GLCD_BusWrite(di, value) Bus::write(di, value)
+
+#define GLCD_Ctx ctx_
+#define GLCD_FontRead(p) FontReader::read(p)
+#define GLCD_SetFontReader(f) (void) (f)
+#define ReadPgmData(p) (*(p))
+
+#define GLCD_PROFILE_ENTER()
+#define GLCD_PROFILE_EXIT(id)
+
+#define GLCD_API static
+#define GLCD_CORE_CLASS
+
+template <class Bus, class Geom = Geometry<>, class FontReader = PgmRead, bool Invertible = true>
+class Glcd {
+public:
+    /*
+     * Control
+     */
+
+    // chips that did not leave reset, one bit each, 0 when all are on
+    static uint8_t init(boolean invert) { return GLCD_Init(Invertible && invert); }
+    static void gotoXY(uint8_t x, uint8_t y) { GLCD_GotoXY(x, y); }
+    static void setRotation(uint8_t rotation) { GLCD_SetRotation(rotation); }
+    static void setInverted(boolean invert)
+    {
+        if (Invertible)
+            GLCD_SetInverted(invert);
+    }
+
+    /*
+     * Graphics
+     */
+
+    static void clearPage(uint8_t page, uint8_t color) { GLCD_ClearPage(page, color); }
+    static void clearScreen(uint8_t color) { GLCD_ClearScreen(color); }
+    static void setDot(uint8_t x, uint8_t y, uint8_t color) { GLCD_SetDot(x, y, color); }
+    static void drawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t color) { GLCD_DrawLine(x1, y1, x2, y2, color); }
+    static void drawPolyline(const lcdPoint *points, uint8_t n, uint8_t color) { GLCD_DrawPolyline(points, n, color); }
+    static void plotSamples(uint8_t x0, const uint8_t *samples, uint8_t n, uint8_t yscale, uint8_t color)
+    {
+        GLCD_PlotSamples(x0, samples, n, yscale, color);
+    }
+    static void drawVertLine(uint8_t x, uint8_t y, uint8_t length, uint8_t color) { GLCD_DrawVertLine(x, y, length, color); }
+    static void drawHoriLine(uint8_t x, uint8_t y, uint8_t length, uint8_t color) { GLCD_DrawHoriLine(x, y, length, color); }
+    static void drawRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color) { GLCD_DrawRect(x, y, width, height, color); }
+    static void drawRoundRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t radius, uint8_t color)
+    {
+        GLCD_DrawRoundRect(x, y, width, height, radius, color);
+    }
+    static void drawCircle(uint8_t xCenter, uint8_t yCenter, uint8_t radius, uint8_t color)
+    {
+        GLCD_DrawCircle(xCenter, yCenter, radius, color);
+    }
+    static void fillRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color) { GLCD_FillRect(x, y, width, height, color); }
+    static void invertRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height) { GLCD_InvertRect(x, y, width, height); }
+    static void copyRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t dstX, uint8_t dstY)
+    {
+        GLCD_CopyRect(x, y, width, height, dstX, dstY);
+    }
+    static void scrollRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, int8_t dx, int8_t dy, uint8_t color)
+    {
+        GLCD_ScrollRect(x, y, width, height, dx, dy, color);
+    }
+    static void drawBitmap(const uint8_t *bitmap, uint8_t x, uint8_t y, uint8_t color) { GLCD_DrawBitmap(bitmap, x, y, color); }
+    static void drawBitmapStream(BitmapCallback read, void *source, uint8_t x, uint8_t y, uint8_t color)
+    {
+        GLCD_DrawBitmapStream(read, source, x, y, color);
+    }
+    static void writePage(uint8_t x, uint8_t page, const uint8_t *data, uint8_t count) { GLCD_WritePage(x, page, data, count); }
+
+#ifdef GLCD_FRAMEBUFFER
+    /*
+     * Output engine
+     */
+
+    static void service() { GLCD_Service(); }
+    static bool frameComplete() { return GLCD_FrameComplete(); }
+    static void flush() { GLCD_Flush(); }
+    static void getFrameStats(lcdFrameStats *stats) { GLCD_GetFrameStats(stats); }
+#endif
+
+    /*
+     * Text
+     */
+
+    static void selectFont(const uint8_t *font, uint8_t color = BLACK) { GLCD_SelectFontEx(font, color, 0); }
+    static void cursorTo(uint8_t x, uint8_t y) { GLCD_CursorTo(x, y); }
+    static bool putChar(char c) { return GLCD_PutChar(c) != 0; }
+    static void puts(const char *str) { GLCD_Puts(str); }
+    static void putsUtf8(const char *str) { GLCD_PutsUtf8(str); }
+    static void printNumber(long n) { GLCD_PrintNumber(n); }
+    static void printHexNumber(uint16_t n) { GLCD_PrintHexNumber(n); }
+    static void printRealNumber(double n) { GLCD_PrintRealNumber(n); }
+    static uint8_t charWidth(char c) { return GLCD_CharWidth(c); }
+    static uint16_t stringWidth(const char *str) { return GLCD_StringWidth(str); }
+    // returns the text that didn't fit
+    static const char *textBox(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const char *str, uint8_t flags)
+    {
+        return GLCD_TextBox(x, y, width, height, str, flags);
+    }
+
+private:
+    static Context<Geom, Invertible> ctx_;
+
+#include "GLCD_Core.h"
+};
+
+template <class Bus, class Geom, class FontReader, bool Invertible>
+Context<Geom, Invertible> Glcd<Bus, Geom, FontReader, Invertible>::ctx_;
+
+#undef GLCD_PastWidth
+#undef GLCD_ChipOf
+#undef GLCD_ChipCol
+#undef GLCD_SelectChip
+#undef GLCD_BusInit
+#undef GLCD_BusReset
+#undef GLCD_BusPoll
+#undef GLCD_BusRead
+#undef GLCD_BusWrite
+#undef GLCD_Ctx
+#undef GLCD_FontRead
+#undef GLCD_SetFontReader
+#undef ReadPgmData
+#undef GLCD_PROFILE_ENTER
+#undef GLCD_PROFILE_EXIT
+#undef GLCD_API
+#undef GLCD_CORE_CLASS
+#pragma pop_macro("_BV")
+#pragma pop_macro("GLCD_CHIP_COUNT")
+#pragma pop_macro("CHIP_WIDTH")
+#pragma pop_macro("DISPLAY_PAGES")
+#pragma pop_macro("DISPLAY_HEIGHT")
+#pragma pop_macro("DISPLAY_WIDTH")
+
+} // namespace glcd
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ *
+ * System5x7Latin
+ *
+ *
+ * File Name           : SystemFont5x7Latin.h
+ * Font size in bytes  : 786
+ * Font width          : 5
+ * Font height         : 7
+ * Font glyphs         : 120 in 25 ranges
+ *
+ * System5x7 plus the Latin-1 letters and signs of Spanish and German, the
+ * euro sign and U+FFFD as the fallback, in the range font format:
+ *
+ * struct _FONT_ {
+ *     uint16_t   font_Size_in_Bytes_over_all_included_Size_it_self;
+ *     uint8_t    font_Width_in_Pixel_for_fixed_drawing;    // 0 with a width table
+ *     uint8_t    font_Height_in_Pixel_for_all_characters;
+ *     uint8_t    font_First_Char;                          // 0
+ *     uint8_t    font_Char_Count;                          // 0, marks a range font
+ *     uint8_t    font_Range_Count;
+ *     uint16_t   font_Glyph_Count;
+ *     uint16_t   font_Fallback;                            // code drawn for missing ones
+ *
+ *     struct {
+ *         uint16_t first;                                  // first code, ascending
+ *         uint8_t  count;
+ *         uint16_t glyph;                                  // glyph number of the first
+ *         uint16_t column;                                 // data column of the first
+ *     } font_Ranges[font_Range_Count];
+ *
+ *     uint8_t    font_Char_Widths[font_Glyph_Count];       // only with a width table
+ *
+ *     uint8_t    font_data[];
+ *                  // bit field of all glyphs, bit 0 is the top row of each page
+ * }
+ *
+ * 16 bit fields are stored high byte first.
+ */
+
+#include <stdint.h>
+
+#ifndef SYSTEM5x7LATIN_H
+#define SYSTEM5x7LATIN_H
+
+#define PROGMEM
+
+#define SYSTEM5x7LATIN_WIDTH 5
+#define SYSTEM5x7LATIN_HEIGHT 7
+
+static const uint8_t System5x7Latin[] PROGMEM = {
+    0x03, 0x12, // size
+    0x05, // width
+    0x07, // height
+    0x00, // first char
+    0x00, // char count, 0 for a range font
+    0x19, // ranges
+    0x00, 0x78, // glyphs
+    0xFF, 0xFD, // fallback
+    
+    // ranges: first, count, glyph, column
+    0x00, 0x20, 0x60, 0x00, 0x00, 0x00, 0x00, // U+0020
+    0x00, 0xA1, 0x01, 0x00, 0x60, 0x01, 0xE0, // U+00A1
+    0x00, 0xB0, 0x01, 0x00, 0x61, 0x01, 0xE5, // U+00B0
+    0x00, 0xBF, 0x01, 0x00, 0x62, 0x01, 0xEA, // U+00BF
+    0x00, 0xC1, 0x01, 0x00, 0x63, 0x01, 0xEF, // U+00C1
+    0x00, 0xC4, 0x01, 0x00, 0x64, 0x01, 0xF4, // U+00C4
+    0x00, 0xC9, 0x01, 0x00, 0x65, 0x01, 0xF9, // U+00C9
+    0x00, 0xCD, 0x01, 0x00, 0x66, 0x01, 0xFE, // U+00CD
+    0x00, 0xD1, 0x01, 0x00, 0x67, 0x02, 0x03, // U+00D1
+    0x00, 0xD3, 0x01, 0x00, 0x68, 0x02, 0x08, // U+00D3
+    0x00, 0xD6, 0x01, 0x00, 0x69, 0x02, 0x0D, // U+00D6
+    0x00, 0xDA, 0x01, 0x00, 0x6A, 0x02, 0x12, // U+00DA
+    0x00, 0xDC, 0x01, 0x00, 0x6B, 0x02, 0x17, // U+00DC
+    0x00, 0xDF, 0x01, 0x00, 0x6C, 0x02, 0x1C, // U+00DF
+    0x00, 0xE1, 0x01, 0x00, 0x6D, 0x02, 0x21, // U+00E1
+    0x00, 0xE4, 0x01, 0x00, 0x6E, 0x02, 0x26, // U+00E4
+    0x00, 0xE9, 0x01, 0x00, 0x6F, 0x02, 0x2B, // U+00E9
+    0x00, 0xED, 0x01, 0x00, 0x70, 0x02, 0x30, // U+00ED
+    0x00, 0xF1, 0x01, 0x00, 0x71, 0x02, 0x35, // U+00F1
+    0x00, 0xF3, 0x01, 0x00, 0x72, 0x02, 0x3A, // U+00F3
+    0x00, 0xF6, 0x01, 0x00, 0x73, 0x02, 0x3F, // U+00F6
+    0x00, 0xFA, 0x01, 0x00, 0x74, 0x02, 0x44, // U+00FA
+    0x00, 0xFC, 0x01, 0x00, 0x75, 0x02, 0x49, // U+00FC
+    0x20, 0xAC, 0x01, 0x00, 0x76, 0x02, 0x4E, // U+20AC
+    0xFF, 0xFD, 0x01, 0x00, 0x77, 0x02, 0x53, // U+FFFD
+    
+    // font data
+    0x00, 0x00, 0x00, 0x00, 0x00,// (space)
+    0x00, 0x00, 0x5F, 0x00, 0x00,// !
+    0x00, 0x07, 0x00, 0x07, 0x00,// "
+    0x14, 0x7F, 0x14, 0x7F, 0x14,// #
+    0x24, 0x2A, 0x7F, 0x2A, 0x12,// $
+    0x23, 0x13, 0x08, 0x64, 0x62,// %
+    0x36, 0x49, 0x55, 0x22, 0x50,// &
+    0x00, 0x05, 0x03, 0x00, 0x00,// '
+    0x00, 0x1C, 0x22, 0x41, 0x00,// (
+    0x00, 0x41, 0x22, 0x1C, 0x00,// )
+    0x08, 0x2A, 0x1C, 0x2A, 0x08,// *
+    0x08, 0x08, 0x3E, 0x08, 0x08,// +
+    0x00, 0x50, 0x30, 0x00, 0x00,// ,
+    0x08, 0x08, 0x08, 0x08, 0x08,// -
+    0x00, 0x60, 0x60, 0x00, 0x00,// .
+    0x20, 0x10, 0x08, 0x04, 0x02,// /
+    0x3E, 0x51, 0x49, 0x45, 0x3E,// 0
+    0x00, 0x42, 0x7F, 0x40, 0x00,// 1
+    0x42, 0x61, 0x51, 0x49, 0x46,// 2
+    0x21, 0x41, 0x45, 0x4B, 0x31,// 3
+    0x18, 0x14, 0x12, 0x7F, 0x10,// 4
+    0x27, 0x45, 0x45, 0x45, 0x39,// 5
+    0x3C, 0x4A, 0x49, 0x49, 0x30,// 6
+    0x01, 0x71, 0x09, 0x05, 0x03,// 7
+    0x36, 0x49, 0x49, 0x49, 0x36,// 8
+    0x06, 0x49, 0x49, 0x29, 0x1E,// 9
+    0x00, 0x36, 0x36, 0x00, 0x00,// :
+    0x00, 0x56, 0x36, 0x00, 0x00,// ;
+    0x00, 0x08, 0x14, 0x22, 0x41,// <
+    0x14, 0x14, 0x14, 0x14, 0x14,// =
+    0x41, 0x22, 0x14, 0x08, 0x00,// >
+    0x02, 0x01, 0x51, 0x09, 0x06,// ?
+    0x32, 0x49, 0x79, 0x41, 0x3E,// @
+    0x7E, 0x11, 0x11, 0x11, 0x7E,// A
+    0x7F, 0x49, 0x49, 0x49, 0x36,// B
+    0x3E, 0x41, 0x41, 0x41, 0x22,// C
+    0x7F, 0x41, 0x41, 0x22, 0x1C,// D
+    0x7F, 0x49, 0x49, 0x49, 0x41,// E
+    0x7F, 0x09, 0x09, 0x01, 0x01,// F
+    0x3E, 0x41, 0x41, 0x51, 0x32,// G
+    0x7F, 0x08, 0x08, 0x08, 0x7F,// H
+    0x00, 0x41, 0x7F, 0x41, 0x00,// I
+    0x20, 0x40, 0x41, 0x3F, 0x01,// J
+    0x7F, 0x08, 0x14, 0x22, 0x41,// K
+    0x7F, 0x40, 0x40, 0x40, 0x40,// L
+    0x7F, 0x02, 0x04, 0x02, 0x7F,// M
+    0x7F, 0x04, 0x08, 0x10, 0x7F,// N
+    0x3E, 0x41, 0x41, 0x41, 0x3E,// O
+    0x7F, 0x09, 0x09, 0x09, 0x06,// P
+    0x3E, 0x41, 0x51, 0x21, 0x5E,// Q
+    0x7F, 0x09, 0x19, 0x29, 0x46,// R
+    0x46, 0x49, 0x49, 0x49, 0x31,// S
+    0x01, 0x01, 0x7F, 0x01, 0x01,// T
+    0x3F, 0x40, 0x40, 0x40, 0x3F,// U
+    0x1F, 0x20, 0x40, 0x20, 0x1F,// V
+    0x7F, 0x20, 0x18, 0x20, 0x7F,// W
+    0x63, 0x14, 0x08, 0x14, 0x63,// X
+    0x03, 0x04, 0x78, 0x04, 0x03,// Y
+    0x61, 0x51, 0x49, 0x45, 0x43,// Z
+    0x00, 0x00, 0x7F, 0x41, 0x41,// [
+    0x02, 0x04, 0x08, 0x10, 0x20,// "\"
+    0x41, 0x41, 0x7F, 0x00, 0x00,// ]
+    0x04, 0x02, 0x01, 0x02, 0x04,// ^
+    0x40, 0x40, 0x40, 0x40, 0x40,// _
+    0x00, 0x01, 0x02, 0x04, 0x00,// `
+    0x20, 0x54, 0x54, 0x54, 0x78,// a
+    0x7F, 0x48, 0x44, 0x44, 0x38,// b
+    0x38, 0x44, 0x44, 0x44, 0x20,// c
+    0x38, 0x44, 0x44, 0x48, 0x7F,// d
+    0x38, 0x54, 0x54, 0x54, 0x18,// e
+    0x08, 0x7E, 0x09, 0x01, 0x02,// f
+    0x08, 0x14, 0x54, 0x54, 0x3C,// g
+    0x7F, 0x08, 0x04, 0x04, 0x78,// h
+    0x00, 0x44, 0x7D, 0x40, 0x00,// i
+    0x20, 0x40, 0x44, 0x3D, 0x00,// j
+    0x00, 0x7F, 0x10, 0x28, 0x44,// k
+    0x00, 0x41, 0x7F, 0x40, 0x00,// l
+    0x7C, 0x04, 0x18, 0x04, 0x78,// m
+    0x7C, 0x08, 0x04, 0x04, 0x78,// n
+    0x38, 0x44, 0x44, 0x44, 0x38,// o
+    0x7C, 0x14, 0x14, 0x14, 0x08,// p
+    0x08, 0x14, 0x14, 0x18, 0x7C,// q
+    0x7C, 0x08, 0x04, 0x04, 0x08,// r
+    0x48, 0x54, 0x54, 0x54, 0x20,// s
+    0x04, 0x3F, 0x44, 0x40, 0x20,// t
+    0x3C, 0x40, 0x40, 0x20, 0x7C,// u
+    0x1C, 0x20, 0x40, 0x20, 0x1C,// v
+    0x3C, 0x40, 0x30, 0x40, 0x3C,// w
+    0x44, 0x28, 0x10, 0x28, 0x44,// x
+    0x0C, 0x50, 0x50, 0x50, 0x3C,// y
+    0x44, 0x64, 0x54, 0x4C, 0x44,// z
+    0x00, 0x08, 0x36, 0x41, 0x00,// {
+    0x00, 0x00, 0x7F, 0x00, 0x00,// |
+    0x00, 0x41, 0x36, 0x08, 0x00,// }
+    0x08, 0x08, 0x2A, 0x1C, 0x08,// ->
+    0x08, 0x1C, 0x2A, 0x08, 0x08,// <-
+    0x00, 0x00, 0x7A, 0x00, 0x00,// U+00A1 inverted exclamation
+    0x00, 0x06, 0x09, 0x09, 0x06,// U+00B0 degree
+    0x30, 0x48, 0x45, 0x40, 0x20,// U+00BF inverted question
+    0x7C, 0x12, 0x12, 0x13, 0x7C,// U+00C1 A acute
+    0x7C, 0x13, 0x12, 0x13, 0x7C,// U+00C4 A diaeresis
+    0x7E, 0x4A, 0x4A, 0x4B, 0x42,// U+00C9 E acute
+    0x00, 0x42, 0x7E, 0x43, 0x00,// U+00CD I acute
+    0x7C, 0x0A, 0x11, 0x22, 0x7D,// U+00D1 N tilde
+    0x3C, 0x42, 0x42, 0x43, 0x3C,// U+00D3 O acute
+    0x3C, 0x43, 0x42, 0x43, 0x3C,// U+00D6 O diaeresis
+    0x3E, 0x40, 0x40, 0x41, 0x3E,// U+00DA U acute
+    0x3C, 0x41, 0x40, 0x41, 0x3C,// U+00DC U diaeresis
+    0x7E, 0x01, 0x49, 0x36, 0x00,// U+00DF sharp s
+    0x20, 0x54, 0x56, 0x55, 0x78,// U+00E1 a acute
+    0x20, 0x55, 0x54, 0x55, 0x78,// U+00E4 a diaeresis
+    0x38, 0x54, 0x56, 0x55, 0x18,// U+00E9 e acute
+    0x00, 0x44, 0x7C, 0x42, 0x01,// U+00ED i acute
+    0x7C, 0x0A, 0x05, 0x06, 0x79,// U+00F1 n tilde
+    0x38, 0x44, 0x46, 0x45, 0x38,// U+00F3 o acute
+    0x38, 0x45, 0x44, 0x45, 0x38,// U+00F6 o diaeresis
+    0x3C, 0x40, 0x42, 0x21, 0x7C,// U+00FA u acute
+    0x3C, 0x41, 0x40, 0x21, 0x7C,// U+00FC u diaeresis
+    0x14, 0x3E, 0x55, 0x55, 0x41,// U+20AC euro
+    0x7D, 0x7E, 0x2E, 0x76, 0x79 // U+FFFD replacement, drawn for codes the font lacks
+    
+};
+
+#endif
@@ -10,1016 +10,493 @@
  */
 
 #include <stdint.h>
+#ifndef GLCD_HOST
 #include <xc.h>
+#endif
 
 #include "GLCD.h"
 
-#define delay(ms) __delay_ms(ms)
-
-#define EN_DELAY() __delay_us(2)
-
 /* GLCD Macros */
 #define INPUT_MODE  0xFF
 #define OUTPUT_MODE 0x00
 
 #define _BV(i) (1 << (i))
-#define isFixedWidthFont(font)  (GLCD_FontRead(font+FONT_LENGTH) == 0 && GLCD_FontRead(font+FONT_LENGTH+1) == 0)
 
+/*
+ * A uint8_t column past the right edge. A 256 column panel has none, so the
+ * test is compiled out there instead of comparing against 255.
+ */
+#if DISPLAY_WIDTH > 255
+#define GLCD_PastWidth(x) 0
+#else
+#define GLCD_PastWidth(x) ((x) > DISPLAY_WIDTH - 1)
+#endif
+
+/*
+ * Chip index and column within the chip of a display column. Shifts and masks
+ * are spelled out for power of two chip widths since the compiler may not
+ * reduce the division itself.
+ */
+#if CHIP_WIDTH == 64
+#define CHIP_SHIFT 6
+#elif CHIP_WIDTH == 32
+#define CHIP_SHIFT 5
+#elif CHIP_WIDTH == 128
+#define CHIP_SHIFT 7
+#endif
+
+#ifdef CHIP_SHIFT
+#define GLCD_ChipOf(x)  ((x) >> CHIP_SHIFT)
+#define GLCD_ChipCol(x) ((x) & (CHIP_WIDTH - 1))
+#else
+#define GLCD_ChipOf(x)  ((x) / CHIP_WIDTH)
+#define GLCD_ChipCol(x) ((x) % CHIP_WIDTH)
+#endif
+
+/* Chip select line (or decoder output) of a chip of the current panel */
+#if GLCD_PANELS > 1
+#define GLCD_BusChip(chip) (GLCD_Ctx.panel * GLCD_CHIP_COUNT + (chip))
+#else
+#define GLCD_BusChip(chip) (chip)
+#endif
+
+/*
+ * Bus backends. Each one provides
+ *
+ *   GLCD_SelectChip(chip)      addresses chip for the accesses that follow
+ *   GLCD_BusInit()             sets the idle state of the lines
+ *   GLCD_BusReset()            pulses the reset line, if there is one
+ *   GLCD_BusPoll()             waits until the selected chip is not busy
+ *   GLCD_BusRead(di)           reads the data (di = 1) or status (di = 0) register
+ *   GLCD_BusWrite(di, value)   writes a data (di = 1) or command (di = 0) byte
+ *
+ * and, if it defines GLCD_BUS_RUN, bulk transfers to the selected chip that
+ * handle its busy time between bytes themselves:
+ *
+ *   GLCD_BusWriteRun(data, step, n)    n data bytes step apart, 0 repeats one
+ *   GLCD_BusReadRun(buf, n)            n data bytes
+ */
 #define GLCD_Enable()		\
 	do {			\
-		EN_DELAY();	\
+		SETUP_DELAY();	\
 		fastWriteHigh(EN); /* EN high level width min 450 ns */ \
 		EN_DELAY();		\
 		fastWriteLow(EN);	\
-		EN_DELAY(); /* Some displays may need this delay at the end of the enable pulse */ \
+		EN_LOW_DELAY();	\
 	} while (0)
 
-#define GLCD_SelectChip(chip)			\
-	do {					\
-            CSEL1 = chip;       \
-            CSEL2 = !chip;      \
-	} while (0)
-
-#define GLCD_WaitReady(chip)                        \
-    do {                                            \
-        /* wait until LCD busy bit goes to zero */  \
-                                                    \
-        GLCD_SelectChip(chip);                      \
-        lcdDataDir(INPUT_MODE);                     \
-        fastWriteLow(D_I);                          \
-        fastWriteHigh(R_W);                         \
-        fastWriteHigh(EN);                          \
-        EN_DELAY();                                 \
-        while (GLCD_DIN_REG & LCD_BUSY_FLAG);   \
-        fastWriteLow(EN);                           \
-    } while (0)
-
-#define GLCD_ReadData(data)                             \
-    do {                                                \
-        GLCD_DoReadData(1); /* dummy read */            \
-        data = GLCD_DoReadData(0); /* "real" read */    \
-    } while (0)
-
-#define GLCD_WriteCommand(cmd, chip)                    \
-    do {                                                \
-                                                                                 \
-        GLCD_WaitReady(chip);                                                               \
-        fastWriteLow(D_I);                                                                  \
-        fastWriteLow(R_W);                                                                  \
-        lcdDataDir(OUTPUT_MODE);                                                            \
-                                                                                            \
-        EN_DELAY();                                                                         \
-        lcdDataOut(cmd);                                                                    \
-        GLCD_Enable();                                                                      \
-        EN_DELAY();                                                                         \
-        EN_DELAY();                                                                         \
-        lcdDataOut(0x00);                                                                   \
-    }  while (0)
-
-/* GLCD control variables */
-static lcdCoord GLCD_Coord;
-static boolean GLCD_Inverted;
-static FontCallback GLCD_FontRead;
-static uint8_t GLCD_FontColor;
-static const uint8_t* GLCD_Font;
-
-/* GLCD private functions */
-uint8_t GLCD_DoReadData(uint8_t first);
-void GLCD_WriteData(uint8_t data); // experts can make this public but the functionality is not documented
-
-//#define GLCD_DEBUG  // uncomment this if you want to slow down drawing to see how pixels are set
-
-void GLCD_ClearPage(uint8_t page, uint8_t color)
-{
-    for (uint8_t x = 0; x < DISPLAY_WIDTH; x++) {
-        GLCD_GotoXY(x, page * 8);
-        GLCD_WriteData(color);
-    }
-}
-
-void GLCD_ClearScreen(uint8_t color)
-{
-    uint8_t page;
-    for (page = 0; page < 8; page++) {
-        GLCD_GotoXY(0, page * 8);
-        GLCD_ClearPage(page, color);
-    }
-}
-
+#if defined(GLCD_BUS_SPI)
 /*
- * First, define a few macros to make the DrawLine code below read more like
- * the wikipedia example code.
+ * 74HC595 shift registers on the MSSP SPI port, chained SDO -> data register
+ * -> control register (GLCD_SPI_DI and friends in GLCD.h), so the control
+ * byte is sent first. The data lines are read back through a 74HC165 on SDI.
+ * EN, the 595 latch, the 165 load and the data register output enable are
+ * port pins, see GLCD_Pins.h.
  */
+#define GLCD_BUS_RUN
 
-#define _GLCD_absDiff(x,y) ((x>y) ?  (x-y) : (y-x))
-#define _GLCD_swap(a,b) \
-do\
-{\
-uint8_t t;\
-	t=a;\
-	a=b;\
-	b=t;\
-} while(0)
-
-void GLCD_DrawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t color)
-{
-    uint8_t deltax, deltay, x, y, steep;
-    int8_t error, ystep;
-
-    steep = _GLCD_absDiff(y1, y2) > _GLCD_absDiff(x1, x2);
-
-    if (steep) {
-        _GLCD_swap(x1, y1);
-        _GLCD_swap(x2, y2);
-    }
-
-    if (x1 > x2) {
-        _GLCD_swap(x1, x2);
-        _GLCD_swap(y1, y2);
-    }
+/* time to shift out the two bytes of an access, SPI clock at Fosc/4 */
+#ifndef GLCD_SPI_SHIFT_NS
+#define GLCD_SPI_SHIFT_NS (64000UL / (_XTAL_FREQ / 1000000UL))
+#endif
+/* rest of the busy time once the next byte is shifted in and EN was low */
+#define GLCD_SPI_GAP_NS (GLCD_T_BUSY > GLCD_SPI_SHIFT_NS + GLCD_T_PWEL ? GLCD_T_BUSY - GLCD_SPI_SHIFT_NS - GLCD_T_PWEL : 0)
 
-    deltax = x2 - x1;
-    deltay = _GLCD_absDiff(y2, y1);
-    error = deltax / 2;
-    y = y1;
-    if (y1 < y2) ystep = 1;
-    else ystep = -1;
+static GLCD_TLS uint8_t GLCD_SpiCtl = GLCD_SPI_RST; /* chip selects and RST */
 
-    for (x = x1; x <= x2; x++) {
-        if (steep) GLCD_SetDot(y, x, color);
-        else GLCD_SetDot(x, y, color);
-        error = error - deltay;
-        if (error < 0) {
-            y = y + ystep;
-            error = error + deltax;
-        }
-    }
-}
+#ifdef GLCD_CS_DECODER
+#define GLCD_SpiCs(cs) (cs)
+#else
+#define GLCD_SpiCs(cs) (GLCD_CS_ACTIVE ? _BV(cs) : 0x0F & ~_BV(cs))
+#endif
+#define GLCD_SelectChip(chip) GLCD_SpiCtl = (GLCD_SpiCtl & 0xF0) | GLCD_SpiCs(GLCD_BusChip(chip))
 
-void GLCD_DrawRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color)
+#ifndef GLCD_SPI_XFER
+static uint8_t GLCD_SpiXfer(uint8_t out)
 {
-    GLCD_DrawHoriLine(x, y, width, color); // top
-    GLCD_DrawHoriLine(x, y + height, width, color); // bottom
-    GLCD_DrawVertLine(x, y, height, color); // left
-    GLCD_DrawVertLine(x + width, y, height, color); // right
+    GLCD_SPI_BUF = out;
+    while (!GLCD_SPI_DONE());
+    return GLCD_SPI_BUF;
 }
+#define GLCD_SPI_XFER(b) GLCD_SpiXfer(b)
+#endif
 
-void GLCD_DrawRoundRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t radius, uint8_t color)
-{
-    int16_t tSwitch, x1 = 0, y1 = radius;
-    tSwitch = 3 - 2 * radius;
-
-    while (x1 <= y1) {
-        GLCD_SetDot(x + radius - x1, y + radius - y1, color);
-        GLCD_SetDot(x + radius - y1, y + radius - x1, color);
-
-        GLCD_SetDot(x + width - radius + x1, y + radius - y1, color);
-        GLCD_SetDot(x + width - radius + y1, y + radius - x1, color);
-
-        GLCD_SetDot(x + width - radius + x1, y + height - radius + y1, color);
-        GLCD_SetDot(x + width - radius + y1, y + height - radius + x1, color);
-
-        GLCD_SetDot(x + radius - x1, y + height - radius + y1, color);
-        GLCD_SetDot(x + radius - y1, y + height - radius + x1, color);
-
-        if (tSwitch < 0) {
-            tSwitch += (4 * x1 + 6);
-        } else {
-            tSwitch += (4 * (x1 - y1) + 10);
-            y1--;
-        }
-        x1++;
-    }
+/* Shifts out a control and a data byte, to be latched with GLCD_SpiLatch() */
+#define GLCD_SpiShift(ctl, data)    \
+    do {                            \
+        GLCD_SPI_XFER(ctl);         \
+        GLCD_SPI_XFER(data);        \
+    } while (0)
 
-    GLCD_DrawHoriLine(x + radius, y, width - (2 * radius), color); // top
-    GLCD_DrawHoriLine(x + radius, y + height, width - (2 * radius), color); // bottom
-    GLCD_DrawVertLine(x, y + radius, height - (2 * radius), color); // left
-    GLCD_DrawVertLine(x + width, y + radius, height - (2 * radius), color); // right
-}
+#define GLCD_SpiLatch()                 \
+    do {                                \
+        fastWriteHigh(GLCD_SPI_LATCH);  \
+        fastWriteLow(GLCD_SPI_LATCH);   \
+    } while (0)
 
-/*
- * Hardware-Functions 
- */
-void GLCD_FillRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t color)
+/* Samples the data lines into the 74HC165 and shifts them in */
+static uint8_t GLCD_SpiSample(void)
 {
-    uint8_t mask, pageOffset, h, i, data;
-    height++;
-
-    pageOffset = y % 8;
-    y -= pageOffset;
-    mask = 0xFF;
-    if (height < 8 - pageOffset) {
-        mask >>= (8 - height);
-        h = height;
-    } else {
-        h = 8 - pageOffset;
-    }
-    mask <<= pageOffset;
-
-    GLCD_GotoXY(x, y);
-    for (i = 0; i <= width; i++) {
-        GLCD_ReadData(data);
-
-        if (color == BLACK) {
-            data |= mask;
-        } else {
-            data &= ~mask;
-        }
-
-        GLCD_WriteData(data);
-    }
-
-    while (h + 8 <= height) {
-        h += 8;
-        y += 8;
-        GLCD_GotoXY(x, y);
-
-        for (i = 0; i <= width; i++) {
-            GLCD_WriteData(color);
-        }
-    }
-
-    if (h < height) {
-        mask = ~(0xFF << (height - h));
-        GLCD_GotoXY(x, y + 8);
-
-        for (i = 0; i <= width; i++) {
-            GLCD_ReadData(data);
-
-            if (color == BLACK) {
-                data |= mask;
-            } else {
-                data &= ~mask;
-            }
-
-            GLCD_WriteData(data);
-        }
-    }
+    fastWriteLow(GLCD_SPI_LOAD);
+    fastWriteHigh(GLCD_SPI_LOAD);
+    return GLCD_SPI_XFER(0);
 }
 
-void GLCD_InvertRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height)
-{
-    uint8_t mask, pageOffset, h, i, data, tmpData;
-    height++;
-
-    pageOffset = y % 8;
-    y -= pageOffset;
-    mask = 0xFF;
-    if (height < 8 - pageOffset) {
-        mask >>= (8 - height);
-        h = height;
-    } else {
-        h = 8 - pageOffset;
-    }
-    mask <<= pageOffset;
-
-    GLCD_GotoXY(x, y);
-    for (i = 0; i <= width; i++) {
-        GLCD_ReadData(data);
-        tmpData = ~data;
-        data = (tmpData & mask) | (data & ~mask);
-        GLCD_WriteData(data);
-    }
-
-    while (h + 8 <= height) {
-        h += 8;
-        y += 8;
-        GLCD_GotoXY(x, y);
-
-        for (i = 0; i <= width; i++) {
-            GLCD_ReadData(data);
-            GLCD_WriteData(~data);
-        }
-    }
-
-    if (h < height) {
-        mask = ~(0xFF << (height - h));
-        GLCD_GotoXY(x, y + 8);
+#define GLCD_BusInit()                  \
+    do {                                \
+        fastWriteLow(EN);               \
+        fastWriteLow(GLCD_SPI_LATCH);   \
+        fastWriteHigh(GLCD_SPI_LOAD);   \
+        fastWriteLow(GLCD_SPI_DOE);     \
+    } while (0)
 
-        for (i = 0; i <= width; i++) {
-            GLCD_ReadData(data);
-            tmpData = ~data;
-            data = (tmpData & mask) | (data & ~mask);
-            GLCD_WriteData(data);
-        }
-    }
-}
+#define GLCD_BusReset()                             \
+    do {                                            \
+        GLCD_SpiShift(GLCD_SpiCtl & ~GLCD_SPI_RST, 0); \
+        GLCD_SpiLatch();                            \
+        RST_DELAY();                                \
+        GLCD_SpiCtl |= GLCD_SPI_RST;                \
+        GLCD_SpiShift(GLCD_SpiCtl, 0);              \
+        GLCD_SpiLatch();                            \
+    } while (0)
 
-void GLCD_SetInverted(boolean invert)
-{ // changed type to boolean
-    if (GLCD_Inverted != invert) {
-        GLCD_InvertRect(0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
-        GLCD_Inverted = invert;
-    }
-}
+/* Sets up a read cycle and raises EN, the data register lets go of the lines */
+#define GLCD_SpiReadCycle(di)                       \
+    do {                                            \
+        fastWriteHigh(GLCD_SPI_DOE);                \
+        GLCD_SpiShift(GLCD_SpiCtl | GLCD_SPI_RW | ((di) ? GLCD_SPI_DI : 0), 0); \
+        GLCD_SpiLatch();                            \
+        SETUP_DELAY();                              \
+        fastWriteHigh(EN);                          \
+        EN_DELAY();                                 \
+    } while (0)
 
-void GLCD_SetDot(uint8_t x, uint8_t y, uint8_t color)
+static void GLCD_BusPoll(void)
 {
-    uint8_t data;
-
-    GLCD_GotoXY(x, y - y % 8); // read data from display memory
-
-    GLCD_ReadData(data);
-    if (color == BLACK) {
-        data |= 0x01 << (y % 8); // set dot
-    } else {
-        data &= ~(0x01 << (y % 8)); // clear dot
-    }
-    GLCD_WriteData(data); // write data back to display
+    GLCD_SpiReadCycle(0);
+    while (GLCD_SpiSample() & LCD_BUSY_FLAG);
+    fastWriteLow(EN);
+    EN_LOW_DELAY();
 }
 
-//
-// Font Functions
-//
-
-uint8_t ReadPgmData(const uint8_t* ptr)
+static uint8_t GLCD_BusRead(uint8_t di)
 {
-    return *ptr;
-}
+    uint8_t data;
 
-void GLCD_SelectFontEx(const uint8_t* font, uint8_t color, FontCallback callback)
-{
-    GLCD_Font = font;
-    GLCD_FontRead = callback;
-    GLCD_FontColor = color;
+    GLCD_SpiReadCycle(di);
+    data = GLCD_SpiSample();
+    fastWriteLow(EN);
+    EN_LOW_DELAY();
+    return data;
 }
 
-void GLCD_PrintNumber(long n)
+static void GLCD_BusWrite(uint8_t di, uint8_t value)
 {
-    byte buf[10]; // prints up to 10 digits
-    byte i = 0;
-    if (n == 0)
-        GLCD_PutChar('0');
-    else {
-        if (n < 0) {
-            GLCD_PutChar('-');
-            n = -n;
-        }
-        while (n > 0 && i <= 10) {
-            buf[i++] = n % 10; // n % base
-            n /= 10; // n/= base
-        }
-        for (; i > 0; i--)
-            GLCD_PutChar((char) (buf[i - 1] < 10 ? '0' + buf[i - 1] : 'A' + buf[i - 1] - 10));
-    }
+    GLCD_SpiShift(GLCD_SpiCtl | (di ? GLCD_SPI_DI : 0), value);
+    GLCD_SpiLatch();
+    fastWriteLow(GLCD_SPI_DOE);
+    GLCD_Enable();
 }
 
-void GLCD_PrintHexNumber(uint16_t n)
+/*
+ * The next byte is shifted in while the chip is busy with the previous one,
+ * and only the rest of GLCD_T_BUSY is waited out, without polling.
+ */
+static void GLCD_BusWriteRun(const uint8_t *data, uint8_t step, uint8_t n)
 {
-    int8_t i;
-    uint8_t d, previous_write = 0;
-
-    if (n == 0) {
-        GLCD_PutChar('0');
-        return;
-    }
-    
-    for (i=3; i>=0; i--) {
-        d = ((0x0F << i*4) & n) >> i*4;
-
-        if (d < 0xA)
-            d += '0';
-        else
-            d = (d - 0xA) + 'A';
-        
-        if (d != '0' || previous_write) {
-            GLCD_PutChar((char) d);
-            previous_write = 1;
-        }
+    uint8_t ctl = GLCD_SpiCtl | GLCD_SPI_DI;
+
+    GLCD_SpiShift(ctl, *data);
+    fastWriteLow(GLCD_SPI_DOE);
+    for (;;) {
+        GLCD_SpiLatch();
+        GLCD_Enable();
+        if (--n == 0)
+            break;
+        data += step;
+        GLCD_SpiShift(ctl, *data);
+        GLCD_DELAY_NS(GLCD_SPI_GAP_NS);
     }
 }
 
-void GLCD_PrintRealNumber(double n)
+static void GLCD_BusReadRun(uint8_t *buf, uint8_t n)
 {
-    long int_part, frac_part;
-    uint8_t sign = 0;
-
-    if (n < 0) {
-        sign = 1;
-        n *= -1;
-    }
-    
-    int_part = (long)n;
-    frac_part = (long)((n - (double)int_part)*1000000);
-    if (sign) GLCD_PutChar('-');
-    GLCD_PrintNumber(int_part);
-    GLCD_PutChar('.');
-
-    while ((frac_part != 0) && (frac_part % 10 == 0)) {
-        frac_part /= 10;
+    for (;;) {
+        *buf++ = GLCD_BusRead(1);
+        if (--n == 0)
+            break;
+        GLCD_DELAY_NS(GLCD_SPI_GAP_NS);
     }
-    
-    GLCD_PrintNumber(frac_part);
 }
 
-#undef GLCD_OLD_FONTDRAW
-
-int GLCD_PutChar(char c)
-{
-    if (GLCD_Font == 0)
-        return 0; // no font selected
-
-    /*
-     * check for special character processing
-     */
-
-    if (c < 0x20) {
-        //SpecialChar(c);
-        return 1;
-    }
-
-    uint8_t width = 0;
-    uint8_t height = GLCD_FontRead(GLCD_Font + FONT_HEIGHT);
-    uint8_t bytes = (height + 7) / 8; /* calculates height in rounded up bytes */
-
-    uint8_t firstChar = GLCD_FontRead(GLCD_Font + FONT_FIRST_CHAR);
-    uint8_t charCount = GLCD_FontRead(GLCD_Font + FONT_CHAR_COUNT);
-
-    uint16_t index = 0;
-    uint8_t x = GLCD_Coord.x, y = GLCD_Coord.y;
-    uint8_t thielefont;
-
-    if (c < firstChar || c >= (firstChar + charCount)) {
-        return 0; // invalid char
-    }
-    c -= firstChar;
-
-    if (isFixedWidthFont(GLCD_Font)) {
-        thielefont = 0;
-        width = GLCD_FontRead(GLCD_Font + FONT_FIXED_WIDTH);
-        index = c * bytes * width + FONT_WIDTH_TABLE;
-    } else {
-        // variable width font, read width data, to get the index
-        thielefont = 1;
-        /*
-         * Because there is no table for the offset of where the data
-         * for each character glyph starts, run the table and add up all the
-         * widths of all the characters prior to the character we
-         * need to locate.
-         */
-        for (uint8_t i = 0; i < c; i++) {
-            index += GLCD_FontRead(GLCD_Font + FONT_WIDTH_TABLE + i);
-        }
-        /*
-         * Calculate the offset of where the font data
-         * for our character starts.
-         * The index value from above has to be adjusted because
-         * there is potentialy more than 1 byte per column in the glyph,
-         * when the characgter is taller than 8 bits.
-         * To account for this, index has to be multiplied
-         * by the height in bytes because there is one byte of font
-         * data for each vertical 8 pixels.
-         * The index is then adjusted to skip over the font width data
-         * and the font header information.
-         */
-
-        index = index * bytes + charCount + FONT_WIDTH_TABLE;
-
-        /*
-         * Finally, fetch the width of our character
-         */
-        width = GLCD_FontRead(GLCD_Font + FONT_WIDTH_TABLE + c);
-    }
-
-    // last but not least, draw the character
-#ifdef GLCD_OLD_FONTDRAW
-    /*================== OLD FONT DRAWING ============================*/
-
-    GLCD_GotoXY(x, y);
-
-    /*
-     * Draw each column of the glyph (character) horizontally
-     * 8 bits (1 page) at a time.
-     * i.e. if a font is taller than 8 bits, draw upper 8 bits first,
-     * Then drop down and draw next 8 bits and so on, until done.
-     * This code depends on WriteData() doing writes that span LCD
-     * memory pages, which has issues because the font data isn't
-     * always a multiple of 8 bits.
-     */
-
-    for (uint8_t i = 0; i < bytes; i++) /* each vertical byte */ {
-        uint16_t page = i*width; // page must be 16 bit to prevent overflow
-        for (uint8_t j = 0; j < width; j++) /* each column */ {
-            uint8_t data = GLCD_FontRead(GLCD_Font + index + page + j);
-
-            /*
-             * This funkyness is because when the character glyph is not a
-             * multiple of 8 in height, the residual bits in the font data
-             * were aligned to the incorrect end of the byte with respect
-             * to the GLCD. I believe that this was an initial oversight (bug)
-             * in Thieles font creator program. It is easily fixed
-             * in the font program but then creates a potential backward
-             * compatiblity problem.
-             *	--- bperrybap
-             */
-
-            if (height > 8 && height < (i + 1)*8) /* is it last byte of multibyte tall font? */ {
-                data >>= (i + 1)*8 - height;
-            }
-
-            if (GLCD_FontColor == BLACK) {
-                GLCD_WriteData(data);
-            } else {
-                GLCD_WriteData(~data);
-            }
-        }
-        // 1px gap between chars
-        if (GLCD_FontColor == BLACK) {
-            GLCD_WriteData(0x00);
-        } else {
-            GLCD_WriteData(0xFF);
-        }
-        GLCD_GotoXY(x, GLCD_Coord.y + 8);
-    }
-    GLCD_GotoXY(x + width + 1, y);
+#elif defined(GLCD_BUS_MEMORY)
+/*
+ * Host only, accesses go straight to the emulated controllers (GLCD_Host.h)
+ * without the pin level protocol.
+ */
+#define GLCD_BUS_RUN
+
+#define GLCD_SelectChip(chip) GLCD_HostBusSelect(GLCD_BusChip(chip))
+#define GLCD_BusInit()
+#define GLCD_BusReset()                 \
+    do {                                \
+        fastWriteLow(RST);              \
+        RST_DELAY();                    \
+        fastWriteHigh(RST);             \
+    } while (0)
+#define GLCD_BusPoll() while (GLCD_HostBusRead(0) & LCD_BUSY_FLAG)
+#define GLCD_BusRead(di) GLCD_HostBusRead(di)
+#define GLCD_BusWrite(di, value) GLCD_HostBusWrite(di, value)
+#define GLCD_BusWriteRun(data, step, n) GLCD_HostBusWriteRun(data, step, n)
+#define GLCD_BusReadRun(buf, n) GLCD_HostBusReadRun(buf, n)
 
-    /*================== END of OLD FONT DRAWING ============================*/
 #else
+/* 8 bit parallel port, pins in GLCD_Pins.h */
 
-    /*================== NEW FONT DRAWING ===================================*/
-
-    /*
-     * Paint font data bits and write them to LCD memory 1 LCD page at a time.
-     * This is very different from simply reading 1 byte of font data
-     * and writing all 8 bits to LCD memory and expecting the write data routine
-     * to fragement the 8 bits across LCD 2 memory pages when necessary.
-     * That method (really doesn't work) and reads and writes the same LCD page
-     * more than once as well as not do sequential writes to memory.
-     *
-     * This method of rendering while much more complicated, somewhat scrambles the font
-     * data reads to ensure that all writes to LCD pages are always sequential and a given LCD
-     * memory page is never read or written more than once.
-     * And reads of LCD pages are only done at the top or bottom of the font data rendering
-     * when necessary.
-     * i.e it ensures the absolute minimum number of LCD page accesses
-     * as well as does the sequential writes as much as possible.
-     *
-     */
-
-    uint8_t pixels = height + 1; /* 1 for gap below character*/
-    uint8_t p;
-    uint8_t dy;
-    uint8_t tfp;
-    uint8_t dp;
-    uint8_t dbyte;
-    uint8_t fdata;
-
-    for (p = 0; p < pixels;) {
-        dy = y + p;
-
-        /*
-         * Align to proper Column and page in LCD memory
-         */
-
-        GLCD_GotoXY(x, (dy & ~7));
-
-        uint16_t page = p / 8 * width; // page must be 16 bit to prevent overflow
-
-        for (uint8_t j = 0; j < width; j++) /* each column of font data */ {
-
-            /*
-             * Fetch proper byte of font data.
-             * Note:
-             * This code "cheats" to add the horizontal space/pixel row
-             * below the font.
-             * It essentially creates a font pixel of 0 when the pixels are
-             * out of the defined pixel map.
-             *
-             * fake a fondata read read when we are on the very last
-             * bottom "pixel". This lets the loop logic continue to run
-             * with the extra fake pixel. If the loop is not the
-             * the last pixel the pixel will come from the actual
-             * font data, but that is ok as it is 0 padded.
-             *
-             */
-
-            if (p >= height) {
-                /*
-                 * fake a font data read for padding below character.
-                 */
-                fdata = 0;
-            } else {
-                fdata = GLCD_FontRead(GLCD_Font + index + page + j);
-
-                /*
-                 * Have to shift font data because Thiele shifted residual
-                 * font bits the wrong direction for LCD memory.
-                 *
-                 * The real solution to this is to fix the variable width font format to
-                 * not shift the residual bits the wrong direction!!!!
-                 */
-                if (thielefont && (height - (p&~7)) < 8) {
-                    fdata >>= 8 - (height & 7);
-                }
-            }
-
-            if (GLCD_FontColor == WHITE)
-                fdata ^= 0xff; /* inverted data for "white" font color	*/
-
-
-            /*
-             * Check to see if a quick full byte write of font
-             * data can be done.
-             */
-
-            if (!(dy & 7) && !(p & 7) && ((pixels - p) >= 8)) {
-                /*
-                 * destination pixel is on a page boundary
-                 * Font data is on byte boundary
-                 * And there are 8 or more pixels left
-                 * to paint so a full byte write can be done.
-                 */
-
-                GLCD_WriteData(fdata);
-                continue;
-            } else {
-                /*
-                 * No, so must fetch byte from LCD memory.
-                 */
-                GLCD_ReadData(dbyte);
-            }
-
-            /*
-             * At this point there is either not a full page of data
-             * left to be painted  or the font data spans multiple font
-             * data bytes. (or both) So, the font data bits will be painted
-             * into a byte and then written to the LCD memory.page.
-             */
-
-
-            tfp = p; /* font pixel bit position 		*/
-            dp = dy & 7; /* data byte pixel bit position */
-
-            /*
-             * paint bits until we hit bottom of page/byte
-             * or run out of pixels to paint.
-             */
-            while ((dp <= 7) && (tfp) < pixels) {
-                if (fdata & _BV(tfp & 7)) {
-                    dbyte |= _BV(dp);
-                } else {
-                    dbyte &= ~_BV(dp);
-                }
-
-                /*
-                 * Check for crossing font data bytes
-                 */
-                if ((tfp & 7) == 7) {
-                    fdata = GLCD_FontRead(GLCD_Font + index + page + j + width);
-
-                    /*
-                     * Have to shift font data because Thiele shifted residual
-                     * font bits the wrong direction for LCD memory.
-                     *
-                     */
-
-                    if ((thielefont) && ((height - tfp) < 8)) {
-                        fdata >>= (8 - (height & 7));
-                    }
-
-                    if (GLCD_FontColor == WHITE)
-                        fdata ^= 0xff; /* inverted data for "white" color	*/
-                }
-                tfp++;
-                dp++;
-            }
-
-            /*
-             * Now flush out the painted byte.
-             */
-            GLCD_WriteData(dbyte);
-        }
-
-        /*
-         * now create a horizontal gap (vertical line of pixels) between characters.
-         * Since this gap is "white space", the pixels painted are oposite of the
-         * font color.
-         *
-         * Since full LCD pages are being written, there are 4 combinations of filling
-         * in the this gap page.
-         *	- pixels start at bit 0 and go down less than 8 bits
-         *	- pixels don't start at 0 but go down through bit 7
-         *	- pixels don't start at 0 and don't go down through bit 7 (fonts shorter than 6 hi)
-         *	- pixels start at bit 0 and go down through bit 7 (full byte)
-         *
-         * The code below creates a mask of the bits that should not be painted.
-         *
-         * Then it is easy to paint the desired bits since if the color is WHITE,
-         * the paint bits are set, and if the coloer is not WHITE the paint bits are stripped.
-         * and the paint bits are the inverse of the desired bits mask.
-         */
-
-
-
-        if ((dy & 7) || (pixels - p < 8)) {
-            uint8_t mask = 0;
-
-            GLCD_ReadData(dbyte);
-
-            if (dy & 7)
-                mask |= _BV(dy & 7) - 1;
+#ifdef GLCD_CS_DECODER
+#define GLCD_SelectChip(chip)			\
+	do {					\
+            uint8_t cs = GLCD_BusChip(chip); \
+            CSA0 = cs & 1;      \
+            CSA1 = (cs >> 1) & 1; \
+	} while (0)
+#else
+#define GLCD_CS_LEVEL(cs, n) ((cs) == (n) ? GLCD_CS_ACTIVE : !GLCD_CS_ACTIVE)
+#if GLCD_CS_LINES == 1
+#define GLCD_SelectChip(chip) CSEL1 = GLCD_CS_ACTIVE
+#elif GLCD_CS_LINES == 2
+#define GLCD_SelectChip(chip)			\
+	do {					\
+            uint8_t cs = GLCD_BusChip(chip); \
+            CSEL1 = GLCD_CS_LEVEL(cs, 0); \
+            CSEL2 = GLCD_CS_LEVEL(cs, 1); \
+	} while (0)
+#elif GLCD_CS_LINES == 3
+#define GLCD_SelectChip(chip)			\
+	do {					\
+            uint8_t cs = GLCD_BusChip(chip); \
+            CSEL1 = GLCD_CS_LEVEL(cs, 0); \
+            CSEL2 = GLCD_CS_LEVEL(cs, 1); \
+            CSEL3 = GLCD_CS_LEVEL(cs, 2); \
+	} while (0)
+#else
+#define GLCD_SelectChip(chip)			\
+	do {					\
+            uint8_t cs = GLCD_BusChip(chip); \
+            CSEL1 = GLCD_CS_LEVEL(cs, 0); \
+            CSEL2 = GLCD_CS_LEVEL(cs, 1); \
+            CSEL3 = GLCD_CS_LEVEL(cs, 2); \
+            CSEL4 = GLCD_CS_LEVEL(cs, 3); \
+	} while (0)
+#endif
+#endif
 
-            if ((pixels - p) < 8)
-                mask |= ~(_BV(pixels - p) - 1);
+#define GLCD_BusInit()          \
+    do {                        \
+        fastWriteLow(D_I);      \
+        fastWriteLow(R_W);      \
+        fastWriteLow(EN);       \
+    } while (0)
 
+#ifdef RST
+#define GLCD_BusReset()         \
+    do {                        \
+        fastWriteLow(RST);      \
+        RST_DELAY();            \
+        fastWriteHigh(RST);     \
+    } while (0)
+#endif
 
-            if (GLCD_FontColor == WHITE)
-                dbyte |= ~mask;
-            else
-                dbyte &= mask;
+#define GLCD_BusPoll()                              \
+    do {                                            \
+        /* wait until LCD busy bit goes to zero */  \
+                                                    \
+        lcdDataDir(INPUT_MODE);                     \
+        fastWriteLow(D_I);                          \
+        fastWriteHigh(R_W);                         \
+        SETUP_DELAY();                              \
+        fastWriteHigh(EN);                          \
+        EN_DELAY();                                 \
+        while (GLCD_DIN_REG & LCD_BUSY_FLAG);       \
+        fastWriteLow(EN);                           \
+        EN_LOW_DELAY();                             \
+    } while (0)
 
-        } else {
-            if (GLCD_FontColor == WHITE)
-                dbyte = 0xff;
-            else
-                dbyte = 0;
-        }
+static uint8_t GLCD_BusRead(uint8_t di)
+{
+    uint8_t data;
 
-        GLCD_WriteData(dbyte);
+    lcdDataDir(INPUT_MODE);
+    D_I = di;
+    fastWriteHigh(R_W); // R/W = 1
+    SETUP_DELAY();
 
-        /*
-         * advance the font pixel for the pixels
-         * just painted.
-         */
+    fastWriteHigh(EN); // EN high level width: min. 450ns
+    EN_DELAY();
 
-        p += 8 - (dy & 7);
-    }
+    data = GLCD_DIN_REG;
 
+    fastWriteLow(EN);
+    EN_LOW_DELAY();
+    return data;
+}
 
-    /*
-     * Since this rendering code always starts off with a GotoXY() it really isn't necessary
-     * to do a real GotoXY() to set the h/w location after rendering a character.
-     * We can get away with only setting the s/w version of X & Y.
-     *
-     * Since y didn't change while rendering, it is still correct.
-     * But update x for the pixels rendered.
-     *
-     */
+#define GLCD_BusWrite(di, value)    \
+    do {                            \
+        D_I = di;                   \
+        fastWriteLow(R_W);          \
+        lcdDataDir(OUTPUT_MODE);    \
+        lcdDataOut(value);          \
+        GLCD_Enable();              \
+    } while (0)
+#endif
 
-    GLCD_GotoXY(x + width + 1, y);
+/*
+ * GLCD control variables, in the current lcdContext. Without GLCD_CONTEXTS
+ * there is only the built-in one, addressed directly like plain statics.
+ */
+#if defined(GLCD_CONTEXTS) && defined(GLCD_HOST)
+/*
+ * On the host the built-in context is per thread like the emulated panel.
+ * The address of a thread local is not a constant initializer, so
+ * GLCD_Current stays null until GLCD_Use() and null means the built-in one.
+ */
+static GLCD_TLS lcdContext GLCD_Default;
+static GLCD_TLS lcdContext *GLCD_Current;
+#define GLCD_Ctx (*(GLCD_Current ? GLCD_Current : &GLCD_Default))
+#elif defined(GLCD_CONTEXTS)
+static lcdContext GLCD_Default;
+static lcdContext *GLCD_Current = &GLCD_Default;
+#define GLCD_Ctx (*GLCD_Current)
+#else
+static lcdContext GLCD_Default;
+#define GLCD_Ctx GLCD_Default
+#endif
 
-    /*================== END of NEW FONT DRAWING ============================*/
+/*
+ * Profiling, see GLCD_PROFILE in GLCD.h. GLCD_PROFILE_ENTER() goes after the
+ * declarations of a function and GLCD_PROFILE_EXIT() before each return.
+ */
+#ifdef GLCD_PROFILE
+static GLCD_TLS lcdProfile GLCD_Profile[GLCD_PROF_COUNT];
 
-#endif // NEW_FONTDRAW
+static void GLCD_ProfileAdd(uint8_t id, GLCD_PROFILE_TICK ticks);
 
-    return 1; // valid char
-}
+#define GLCD_PROFILE_ENTER() GLCD_PROFILE_TICK profileStart = GLCD_PROFILE_TIMER()
+#define GLCD_PROFILE_EXIT(id) GLCD_ProfileAdd(id, (GLCD_PROFILE_TICK) (GLCD_PROFILE_TIMER() - profileStart))
+#else
+#define GLCD_PROFILE_ENTER()
+#define GLCD_PROFILE_EXIT(id)
+#endif
 
-void GLCD_Puts(const char *str)
+/* GLCD private functions */
+#ifdef GLCD_CONTEXTS
+void GLCD_Use(lcdContext *ctx)
 {
-    int x = GLCD_Coord.x;
-    while (*str != 0) {
-        if (*str == '\n') {
-            GLCD_GotoXY(x, GLCD_Coord.y + GLCD_FontRead(GLCD_Font + FONT_HEIGHT));
-        } else {
-            GLCD_PutChar(*str);
-        }
-        str++;
-    }
+#ifdef GLCD_HOST
+    GLCD_Current = ctx;
+#else
+    GLCD_Current = ctx ? ctx : &GLCD_Default;
+#endif
 }
+#endif
 
-uint8_t GLCD_CharWidth(char c)
-{
-    uint8_t width = 0;
-    uint8_t firstChar = GLCD_FontRead(GLCD_Font + FONT_FIRST_CHAR);
-    uint8_t charCount = GLCD_FontRead(GLCD_Font + FONT_CHAR_COUNT);
+#include "GLCD_Core.h"
 
-    // read width data
-    if (c >= firstChar && c < (firstChar + charCount)) {
-        c -= firstChar;
-        width = GLCD_FontRead(GLCD_Font + FONT_WIDTH_TABLE + c) + 1;
-    }
-
-    return width;
+uint8_t ReadPgmData(const uint8_t* ptr)
+{
+    return *ptr;
 }
 
-uint16_t GLCD_StringWidth(const char *str)
+#if defined(GLCD_FRAMEBUFFER) && defined(GLCD_CONTEXTS)
+/*
+ * One GLCD_Service() call on each of count contexts, e.g. every panel on the
+ * bus from a single timer interrupt. The current context is restored, so the
+ * drawing code it interrupts is not affected. Takes up to count times
+ * GLCD_SERVICE_BUDGET transfers.
+ */
+void GLCD_ServiceAll(lcdContext *const *ctx, uint8_t count)
 {
-    uint16_t width = 0;
+    lcdContext *current = GLCD_Current;
 
-    while (*str != 0) {
-        width += GLCD_CharWidth(*str++);
+    while (count-- > 0) {
+        GLCD_Current = *ctx++;
+        GLCD_Service();
     }
-
-    return width;
+    GLCD_Current = current;
 }
+#endif
 
-void GLCD_CursorTo(uint8_t x, uint8_t y)
-{ // 0 based coordinates for fixed width fonts (i.e. systemFont5x7)
-    GLCD_GotoXY(x * (GLCD_FontRead(GLCD_Font + FONT_FIXED_WIDTH) + 1),
-            y * (GLCD_FontRead(GLCD_Font + FONT_HEIGHT) + 1));
-}
+#ifdef GLCD_PROFILE
+static const char * const GLCD_ProfileNames[GLCD_PROF_COUNT] = {
+    "Init", "ClearScreen", "DrawLine", "DrawRect", "DrawRoundRect", "FillRect",
+    "InvertRect", "SetInverted", "SetDot", "DrawBitmap", "PutChar", "Puts",
+    "Service", "Flush", "DrawPolyline", "PlotSamples",
+    "CopyRect", "ScrollRect", "DrawBitmapStream", "TextBox",
+    "PutsUtf8"
+};
 
-void GLCD_GotoXY(uint8_t x, uint8_t y)
+static void GLCD_ProfileAdd(uint8_t id, GLCD_PROFILE_TICK ticks)
 {
-    uint8_t chip, cmd;
-
-    if ((x > DISPLAY_WIDTH - 1) || (y > DISPLAY_HEIGHT - 1)) // exit if coordinates are not legal
-        return;
-    GLCD_Coord.x = x; // save new coordinates
-    GLCD_Coord.y = y;
-
-    if (y / 8 != GLCD_Coord.page) {
-        GLCD_Coord.page = y / 8;
-        cmd = LCD_SET_PAGE | GLCD_Coord.page; // set y address on all chips
-        for (chip = 0; chip < DISPLAY_WIDTH / CHIP_WIDTH; chip++) {
-            GLCD_WriteCommand(cmd, chip);
-        }
-    }
-    chip = GLCD_Coord.x / CHIP_WIDTH;
-    x = x % CHIP_WIDTH;
-    cmd = LCD_SET_ADD | x;
-    GLCD_WriteCommand(cmd, chip); // set x address on active chip
+    lcdProfile *p = &GLCD_Profile[id];
+
+    if (p->calls == 0 || ticks < p->min)
+        p->min = ticks;
+    if (ticks > p->max)
+        p->max = ticks;
+    p->calls++;
+    p->total += ticks;
 }
 
-void GLCD_Init(boolean invert)
+void GLCD_ProfileReset(void)
 {
-    /* User must Declare PINs as OUTPUT */
-
-    delay(10);
-
-    fastWriteLow(D_I);
-    fastWriteLow(R_W);
-    fastWriteLow(EN);
-
-#ifdef RST
-    /*
-     * Reset the glcd module if there is a reset pin defined
-     */
-    fastWriteLow(RST);
-    delay(2);
-    fastWriteHigh(RST);
-#endif
-
-    /*
-     *  extra blind delay for slow rising external reset signals
-     *  and to give time for glcd to get up and running
-     */
-#ifdef _PIC18
-    delay(10);
-    delay(10);
-    delay(10);
-    delay(10);
-    delay(10);
-#else
-    delay(50);
-#endif
-
-    GLCD_Coord.x = 0;
-    GLCD_Coord.y = 0;
-    GLCD_Coord.page = 0;
-
-    GLCD_Inverted = invert;
+    uint8_t id;
 
-    for (uint8_t chip = 0; chip < DISPLAY_WIDTH / CHIP_WIDTH; chip++) {
-        delay(10);
-        GLCD_WriteCommand(LCD_ON, chip); // power on
-        GLCD_WriteCommand(LCD_DISP_START, chip); // display start line = 0
+    for (id = 0; id < GLCD_PROF_COUNT; id++) {
+        GLCD_Profile[id].calls = 0;
+        GLCD_Profile[id].total = 0;
+        GLCD_Profile[id].min = 0;
+        GLCD_Profile[id].max = 0;
     }
-    
-#ifdef _PIC18
-    delay(10);
-    delay(10);
-    delay(10);
-    delay(10);
-    delay(10);
-#else
-    delay(50);
-#endif
-    
-    GLCD_ClearScreen(invert ? BLACK : WHITE); // display clear
-    GLCD_GotoXY(0, 0);
 }
 
-uint8_t GLCD_DoReadData(uint8_t first)
+const lcdProfile *GLCD_ProfileGet(uint8_t id)
 {
-    uint8_t data, chip;
-
-    chip = GLCD_Coord.x / CHIP_WIDTH;
-    GLCD_WaitReady(chip);
-    if (first) {
-        if (GLCD_Coord.x % CHIP_WIDTH == 0 && chip > 0) { // todo , remove this test and call GotoXY always?
-            GLCD_GotoXY(GLCD_Coord.x, GLCD_Coord.y);
-            GLCD_WaitReady(chip);
-        }
-    }
-    fastWriteHigh(D_I); // D/I = 1
-    fastWriteHigh(R_W); // R/W = 1
-
-    fastWriteHigh(EN); // EN high level width: min. 450ns
-    EN_DELAY();
-
-    data = GLCD_DIN_REG;
-
-    fastWriteLow(EN);
-    if (first == 0)
-        GLCD_GotoXY(GLCD_Coord.x, GLCD_Coord.y);
-    if (GLCD_Inverted)
-        data = ~data;
-    return data;
+    return id < GLCD_PROF_COUNT ? &GLCD_Profile[id] : 0;
 }
 
-void GLCD_WriteData(uint8_t data)
+/* Decimal without printf, which may not be linked in */
+static void GLCD_ProfileNumber(void (*out)(char c), uint32_t n)
 {
-    uint8_t displayData, yOffset, chip;
-    //showHex("wrData",data);
-    //showXY("wr", GLCD_Coord.x,GLCD_Coord.y);
-
-#ifdef LCD_CMD_PORT	
-    uint8_t cmdPort;
-#endif
-
-#ifdef GLCD_DEBUG
-    volatile uint16_t i;
-    for (i = 0; i < 5000; i++);
-#endif
-
-    if (GLCD_Coord.x >= DISPLAY_WIDTH)
-        return;
-    chip = GLCD_Coord.x / CHIP_WIDTH;
-    GLCD_WaitReady(chip);
-
-
-    if (GLCD_Coord.x % CHIP_WIDTH == 0 && chip > 0) { // todo , ignore address 0???
-        GLCD_GotoXY(GLCD_Coord.x, GLCD_Coord.y);
-    }
-
-    fastWriteHigh(D_I); // D/I = 1
-    fastWriteLow(R_W); // R/W = 0
-    lcdDataDir(OUTPUT_MODE); // data port is output
-
-    yOffset = GLCD_Coord.y % 8;
-
-    if (yOffset != 0) {
-        // first page
-#ifdef LCD_CMD_PORT 
-        cmdPort = LCD_CMD_PORT; // save command port
-#endif
-        GLCD_ReadData(data);
-#ifdef LCD_CMD_PORT 		
-        LCD_CMD_PORT = cmdPort; // restore command port
-#else
-        fastWriteHigh(D_I); // D/I = 1
-        fastWriteLow(R_W); // R/W = 0
-        GLCD_SelectChip(chip);
-#endif
-        lcdDataDir(OUTPUT_MODE); // data port is output
-
-        displayData |= data << yOffset;
-        if (GLCD_Inverted)
-            displayData = ~displayData;
-        lcdDataOut(displayData); // write data
-        GLCD_Enable(); // enable
-
-        // second page
-        GLCD_GotoXY(GLCD_Coord.x, GLCD_Coord.y + 8);
-
-        GLCD_ReadData(displayData);
-
-#ifdef LCD_CMD_PORT 		
-        LCD_CMD_PORT = cmdPort; // restore command port
-#else		
-        fastWriteHigh(D_I); // D/I = 1
-        fastWriteLow(R_W); // R/W = 0
-        GLCD_SelectChip(chip);
-#endif
-        lcdDataDir(OUTPUT_MODE); // data port is output
-
-        displayData |= data >> (8 - yOffset);
-        if (GLCD_Inverted)
-            displayData = ~displayData;
-        lcdDataOut(displayData); // write data
-        GLCD_Enable(); // enable
-
-        GLCD_GotoXY(GLCD_Coord.x + 1, GLCD_Coord.y - 8);
-    } else {
-        // just this code gets executed if the write is on a single page
-        if (GLCD_Inverted)
-            data = ~data;
-        EN_DELAY();
-        lcdDataOut(data); // write data
-        GLCD_Enable(); // enable
-        GLCD_Coord.x++;
-        //showXY("WrData",GLCD_Coord.x, GLCD_Coord.y);
-    }
+    char digits[10];
+    uint8_t i = 0;
+
+    out(' ');
+    do {
+        digits[i++] = '0' + n % 10;
+        n /= 10;
+    } while (n);
+    while (i)
+        out(digits[--i]);
 }
 
-void GLCD_DrawBitmap(const uint8_t * bitmap, uint8_t x, uint8_t y, uint8_t color)
+void GLCD_ProfileDump(void (*out)(char c))
 {
-    uint8_t width, height;
-    uint8_t i, j;
-
-    width = ReadPgmData(bitmap++);
-    height = ReadPgmData(bitmap++);
-    for (j = 0; j < height / 8; j++) {
-        GLCD_GotoXY(x, y + (j * 8));
-        for (i = 0; i < width; i++) {
-            uint8_t displayData = ReadPgmData(bitmap++);
-            if (color == BLACK)
-                GLCD_WriteData(displayData);
-            else
-                GLCD_WriteData(~displayData);
-        }
+    const char *name;
+    uint8_t id;
+
+    for (id = 0; id < GLCD_PROF_COUNT; id++) {
+        const lcdProfile *p = &GLCD_Profile[id];
+
+        if (p->calls == 0)
+            continue;
+        for (name = GLCD_ProfileNames[id]; *name; name++)
+            out(*name);
+        GLCD_ProfileNumber(out, p->calls);
+        GLCD_ProfileNumber(out, p->total);
+        GLCD_ProfileNumber(out, p->min);
+        GLCD_ProfileNumber(out, p->max);
+        out('\n');
     }
 }
-
+#endif
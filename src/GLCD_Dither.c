@@ -0,0 +1,213 @@
+/*
+  GLCD_Dither.c - grayscale images for the PIC GLCD library
+
+  See GLCD_Dither.h.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <stdint.h>
+
+#include "GLCD_Dither.h"
+
+/* 8 x 8 Bayer matrix, a pixel is black when its gray is below 4 * entry + 2 */
+static const uint8_t GLCD_Bayer[8][8] = {
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 }
+};
+
+void GLCD_DitherInit(lcdDither *dither, uint8_t x, uint8_t page, uint8_t width, uint8_t *band, int16_t *error)
+{
+    uint8_t i;
+
+    dither->x = x;
+    dither->page = page;
+    dither->width = width;
+    dither->row = 0;
+    dither->band = band;
+    dither->error = error;
+    for (i = 0; i < width; i++)
+        band[i] = 0;
+    if (error)
+        for (i = 0; i <= width; i++)
+            error[i] = 0;
+}
+
+static void GLCD_DitherFlush(lcdDither *dither)
+{
+    uint8_t i;
+
+    GLCD_WritePage(dither->x, dither->page, dither->band, dither->width);
+    for (i = 0; i < dither->width; i++)
+        dither->band[i] = 0;
+    dither->page++;
+    dither->row = 0;
+}
+
+/*
+ * Floyd-Steinberg keeps the error of the next row in error[x + 1]. The slot
+ * of the pixel down and left was already read for this row, so it takes its
+ * 3/16 at once; the 5/16 below replaces this pixel's slot and the 1/16 down
+ * and right waits a pixel until that slot has been read.
+ */
+void GLCD_DitherRow(lcdDither *dither, const uint8_t *gray)
+{
+    const uint8_t *bayer = GLCD_Bayer[dither->row];
+    uint8_t bit = 1 << dither->row;
+    int16_t *error = dither->error;
+    int16_t v, e, right = 0, downRight = 0;
+    uint8_t i;
+
+    if (dither->page >= DISPLAY_PAGES)
+        return;
+    if (!error) {
+        for (i = 0; i < dither->width; i++)
+            if (gray[i] < bayer[i % 8] * 4 + 2)
+                dither->band[i] |= bit;
+    } else {
+        for (i = 0; i < dither->width; i++) {
+            v = gray[i] + right + error[i + 1];
+            if (v < 128) {
+                dither->band[i] |= bit;
+                e = v;
+            } else {
+                e = v - 255;
+            }
+            right = (e * 7) >> 4;
+            error[i] += (e * 3) >> 4;
+            error[i + 1] = ((e * 5) >> 4) + downRight;
+            downRight = e >> 4;
+        }
+    }
+    if (++dither->row == 8)
+        GLCD_DitherFlush(dither);
+}
+
+/* The rows the image didn't fill are written white */
+void GLCD_DitherEnd(lcdDither *dither)
+{
+    if (dither->row && dither->page < DISPLAY_PAGES)
+        GLCD_DitherFlush(dither);
+}
+
+void GLCD_GrayInit(lcdGray *gray, uint8_t x, uint8_t page, uint8_t width, uint8_t pages, uint8_t *planes)
+{
+    uint16_t i;
+
+    gray->x = x;
+    gray->page = page;
+    gray->width = width;
+    gray->pages = pages;
+    gray->planes = planes;
+    gray->phase = 0;
+    gray->shown = 0;
+    gray->dirtyLo = 0;
+    gray->dirtyHi = width - 1;
+    gray->bytes = 0;
+    for (i = 0; i < 2 * width * pages; i++)
+        planes[i] = 0;
+}
+
+/* Sets the bits of mask in column col, page p of the layer to level */
+static void GLCD_GrayPut(lcdGray *gray, uint8_t col, uint8_t p, uint8_t mask, uint8_t level)
+{
+    uint8_t *hi = gray->planes + (uint16_t) p * gray->width + col;
+    uint8_t *lo = hi + (uint16_t) gray->pages * gray->width;
+
+    *hi = (level & 2) ? *hi | mask : *hi & ~mask;
+    *lo = (level & 1) ? *lo | mask : *lo & ~mask;
+    if (col < gray->dirtyLo)
+        gray->dirtyLo = col;
+    if (col > gray->dirtyHi)
+        gray->dirtyHi = col;
+}
+
+void GLCD_GraySetDot(lcdGray *gray, uint8_t x, uint8_t y, uint8_t level)
+{
+    if (x < gray->x || x - gray->x >= gray->width || y / 8 < gray->page || y / 8 - gray->page >= gray->pages)
+        return;
+    GLCD_GrayPut(gray, x - gray->x, y / 8 - gray->page, 1 << (y % 8), level);
+}
+
+/* Covers x to x + width and y to y + height like GLCD_FillRect(), clipped to the layer */
+void GLCD_GrayFillRect(lcdGray *gray, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t level)
+{
+    int16_t x1 = x, y1 = y, x2 = x + width, y2 = y + height;
+    int16_t col, row, top;
+    uint8_t mask;
+
+    if (x1 < gray->x)
+        x1 = gray->x;
+    if (x2 > gray->x + gray->width - 1)
+        x2 = gray->x + gray->width - 1;
+    if (y1 < gray->page * 8)
+        y1 = gray->page * 8;
+    if (y2 > (gray->page + gray->pages) * 8 - 1)
+        y2 = (gray->page + gray->pages) * 8 - 1;
+
+    for (row = y1 & ~7; row <= y2; row += 8) {
+        mask = 0xFF;
+        top = row;
+        if (y1 > top)
+            mask <<= y1 - top;
+        if (y2 < top + 7)
+            mask &= 0xFF >> (top + 7 - y2);
+        for (col = x1; col <= x2; col++)
+            GLCD_GrayPut(gray, col - gray->x, row / 8 - gray->page, mask, level);
+    }
+}
+
+/*
+ * Writes the plane due for this tick: the dirty columns whole, and elsewhere
+ * the runs of bytes that differ from the plane on the panel.
+ */
+#define GLCD_GrayStale(i) ((changed && cur[i] != other[i]) || (i >= dirtyLo && i <= dirtyHi))
+
+void GLCD_GrayTick(lcdGray *gray)
+{
+    uint8_t show, changed, p, i, start, end, dirtyLo, dirtyHi;
+    uint8_t *cur, *other;
+
+    show = gray->phase == 2;
+    if (++gray->phase == 3)
+        gray->phase = 0;
+    gray->bytes = 0;
+    changed = show != gray->shown;
+    if (!changed && gray->dirtyLo > gray->dirtyHi)
+        return;
+
+    /* the dirty columns are rewritten whole on every page */
+    dirtyLo = gray->dirtyLo;
+    dirtyHi = gray->dirtyHi;
+    gray->dirtyLo = 0xFF;
+    gray->dirtyHi = 0;
+
+    for (p = 0; p < gray->pages; p++) {
+        cur = gray->planes + ((uint16_t) show * gray->pages + p) * gray->width;
+        other = gray->planes + ((uint16_t) !show * gray->pages + p) * gray->width;
+        for (i = 0; i < gray->width;) {
+            if (!GLCD_GrayStale(i)) {
+                i++;
+                continue;
+            }
+            /* a run of changed columns, through gaps of up to GLCD_GRAY_GAP */
+            start = i;
+            end = i;
+            for (i++; i < gray->width && i <= end + GLCD_GRAY_GAP + 1; i++)
+                if (GLCD_GrayStale(i))
+                    end = i;
+            GLCD_WritePage(gray->x + start, gray->page + p, cur + start, end - start + 1);
+            gray->bytes += end - start + 1;
+            i = end + 1;
+        }
+    }
+    gray->shown = show;
+}
@@ -0,0 +1,413 @@
+/*
+  GLCD_Host.c - Host (PC) emulation of a ks0108 panel for the PIC GLCD library
+
+  See GLCD_Host.h for a description of the emulation model.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "GLCD.h"
+
+#define CYCLE_PS    (4000000000000ULL / _XTAL_FREQ)
+#define PWEH_PS     450000ULL
+#define PWEL_PS     450000ULL
+#define CYC_PS      1000000ULL
+
+/* ks0108 status register bits */
+#define STATUS_BUSY     0x80
+#define STATUS_OFF      0x20
+#define STATUS_RESET    0x10
+
+typedef struct {
+    uint8_t ram[GLCD_HOST_PAGES][GLCD_HOST_COLUMNS];
+    uint8_t x;
+    uint8_t page;
+    uint8_t on;
+    uint8_t startLine;
+    uint8_t out;        // output register, loaded by data reads
+    uint8_t held;       // stuck in reset, GLCD_HostHoldReset()
+    uint64_t readyAt;   // end of busy time
+} HostChip;
+
+GLCD_TLS GLCD_HostPinState GLCD_HostPins;
+
+static GLCD_TLS HostChip chips[GLCD_HOST_CHIPS];
+static GLCD_TLS GLCD_HostPinState last;  // pin state at the previous sync
+static GLCD_TLS GLCD_HostStats stats;
+static GLCD_TLS uint64_t now, enRise, enFall, resetAt, statsStart;
+static GLCD_TLS uint8_t din;
+static GLCD_TLS uint16_t spiChain;      // 74HC595 pair, control register in the high byte
+static GLCD_TLS uint8_t spiIn;          // 74HC165
+static GLCD_TLS uint8_t busChip;        // GLCD_HostBusSelect()
+static GLCD_TLS GLCD_HostTraceFn trace;
+
+static uint8_t isSelected(uint8_t chip)
+{
+#ifdef GLCD_CS_DECODER
+    // one decoder output per chip, at GLCD_CS_ACTIVE when addressed
+    return chip == (last.csa0 | (last.csa1 << 1));
+#else
+    // CSELn selects chip n - 1
+    return last.cs[chip] == GLCD_CS_ACTIVE;
+#endif
+}
+
+static uint8_t chipStatus(HostChip *c)
+{
+    uint8_t status = 0;
+
+    if (now < c->readyAt)
+        status |= STATUS_BUSY;
+    if (!c->on)
+        status |= STATUS_OFF;
+    if (!last.rst || now < resetAt || c->held)
+        status |= STATUS_RESET | STATUS_BUSY;
+    return status;
+}
+
+/*
+ * Checks the chip can accept an access and starts its busy time.
+ * Returns 0 if the access is lost because the chip is still busy.
+ */
+static uint8_t chipAccess(HostChip *c)
+{
+    if (chipStatus(c) & STATUS_BUSY) {
+        stats.violations++;
+        return 0;
+    }
+    c->readyAt = now + GLCD_HOST_BUSY_NS * 1000ULL;
+    return 1;
+}
+
+static void chipCommand(HostChip *c, uint8_t cmd)
+{
+    if ((cmd & 0xFE) == 0x3E)
+        c->on = cmd & 1;
+    else if ((cmd & 0xC0) == 0x40)
+        c->x = cmd & 0x3F;
+    else if ((cmd & 0xF8) == 0xB8)
+        c->page = cmd & 0x07;
+    else if ((cmd & 0xC0) == 0xC0)
+        c->startLine = cmd & 0x3F;
+}
+
+/* Data read, the controller returns its output register and reloads it */
+static uint8_t chipRead(HostChip *c)
+{
+    uint8_t data;
+
+    stats.reads++;
+    if (!chipAccess(c))
+        return din;
+    data = c->out;
+    c->out = c->ram[c->page][c->x];
+    c->x = (c->x + 1) % GLCD_HOST_COLUMNS;
+    return data;
+}
+
+static void chipWrite(HostChip *c, uint8_t di, uint8_t value)
+{
+    if (!chipAccess(c))
+        return;
+    if (di) {
+        c->ram[c->page][c->x] = value;
+        c->x = (c->x + 1) % GLCD_HOST_COLUMNS;
+    } else {
+        chipCommand(c, value);
+    }
+}
+
+static void enableRise(void)
+{
+    uint8_t chip;
+
+    if (enFall && (now - enFall < PWEL_PS || now - enRise < CYC_PS))
+        stats.violations++;
+    enRise = now;
+    if (!last.r_w)
+        return;
+
+    for (chip = 0; chip < GLCD_HOST_CHIPS; chip++) {
+        HostChip *c = &chips[chip];
+
+        if (!isSelected(chip))
+            continue;
+        if (!last.d_i) {
+            stats.polls++;
+            din = chipStatus(c);
+        } else {
+            din = chipRead(c);
+        }
+        if (trace)
+            trace(chip, last.d_i ? 'R' : 'S', din);
+    }
+}
+
+static void enableFall(void)
+{
+    uint8_t chip;
+
+    if (now - enRise < PWEH_PS)
+        stats.violations++;
+    enFall = now;
+    if (last.r_w)
+        return;
+
+    if (last.d_i)
+        stats.writes++;
+    else
+        stats.commands++;
+
+    for (chip = 0; chip < GLCD_HOST_CHIPS; chip++) {
+        HostChip *c = &chips[chip];
+
+        if (!isSelected(chip))
+            continue;
+        chipWrite(c, last.d_i, last.dout);
+        if (trace)
+            trace(chip, last.d_i ? 'W' : 'C', last.dout);
+    }
+}
+
+/* Data lines as seen by the PIC port or the 74HC165 */
+static uint8_t busData(void)
+{
+    uint8_t chip;
+
+    if (last.en && last.r_w && !last.d_i) {
+        // the status register is live while EN is high
+        for (chip = 0; chip < GLCD_HOST_CHIPS; chip++) {
+            if (isSelected(chip))
+                din = chipStatus(&chips[chip]);
+        }
+    }
+    return din;
+}
+
+/* 74HC595 storage clock, the shift register pair drives the control lines */
+static void spiLatch(void)
+{
+    uint8_t ctl = spiChain >> 8;
+    uint8_t i;
+
+    GLCD_HostPins.dout = spiChain & 0xFF;
+    GLCD_HostPins.d_i = (ctl & GLCD_SPI_DI) != 0;
+    GLCD_HostPins.r_w = (ctl & GLCD_SPI_RW) != 0;
+    GLCD_HostPins.rst = (ctl & GLCD_SPI_RST) != 0;
+    GLCD_HostPins.csa0 = ctl & 1;
+    GLCD_HostPins.csa1 = (ctl >> 1) & 1;
+    for (i = 0; i < 4; i++)
+        GLCD_HostPins.cs[i] = (ctl >> i) & 1;
+}
+
+/*
+ * Applies the pin changes made since the previous call. The library writes
+ * pins through plain assignments, so edges are only seen on the next access.
+ */
+static void sync(void)
+{
+    if (GLCD_HostPins.latch && !last.latch)
+        spiLatch();
+    if (GLCD_HostPins.rst != last.rst) {
+        uint8_t chip;
+
+        for (chip = 0; chip < GLCD_HOST_CHIPS; chip++) {
+            chips[chip].on = 0;
+            chips[chip].startLine = 0;
+        }
+        resetAt = now + GLCD_HOST_RESET_NS * 1000ULL;
+    }
+    if (GLCD_HostPins.en != last.en) {
+        uint8_t rising = GLCD_HostPins.en;
+
+        last = GLCD_HostPins;
+        if (rising)
+            enableRise();
+        else
+            enableFall();
+    }
+    if (!GLCD_HostPins.load && last.load) {
+        last = GLCD_HostPins;
+        spiIn = busData();
+    }
+    last = GLCD_HostPins;
+}
+
+volatile uint8_t *GLCD_HostPin(volatile uint8_t *pin)
+{
+    sync();
+    now += CYCLE_PS;
+    return pin;
+}
+
+uint8_t GLCD_HostReadPort(void)
+{
+    sync();
+    now += CYCLE_PS;
+    return busData();
+}
+
+/*
+ * MSSP at Fosc/4 shifts a byte in 8 instruction cycles, plus the buffer
+ * write, flag test and buffer read around it.
+ */
+uint8_t GLCD_HostSpiXfer(uint8_t out)
+{
+    uint8_t in;
+
+    sync();
+    now += 11 * CYCLE_PS;
+    spiChain = (spiChain << 8) | out;
+    in = spiIn;
+    spiIn = 0;
+    return in;
+}
+
+/*
+ * Bus level accesses, each one takes GLCD_T_CYC. Status reads don't count as
+ * an access, so a busy chip can be polled.
+ */
+#define BUS_CYCLE_PS (GLCD_T_CYC * 1000ULL)
+
+void GLCD_HostBusSelect(uint8_t chip)
+{
+    sync();
+    now += CYCLE_PS;
+    busChip = chip;
+}
+
+uint8_t GLCD_HostBusRead(uint8_t di)
+{
+    HostChip *c = &chips[busChip];
+
+    sync();
+    now += BUS_CYCLE_PS;
+    if (di) {
+        din = chipRead(c);
+    } else {
+        stats.polls++;
+        din = chipStatus(c);
+    }
+    if (trace)
+        trace(busChip, di ? 'R' : 'S', din);
+    return din;
+}
+
+void GLCD_HostBusWrite(uint8_t di, uint8_t value)
+{
+    sync();
+    now += BUS_CYCLE_PS;
+    if (di)
+        stats.writes++;
+    else
+        stats.commands++;
+    chipWrite(&chips[busChip], di, value);
+    if (trace)
+        trace(busChip, di ? 'W' : 'C', value);
+}
+
+/* Waits for the busy time of the selected chip without a status read */
+static void busWait(void)
+{
+    if (now < chips[busChip].readyAt)
+        now = chips[busChip].readyAt;
+}
+
+void GLCD_HostBusWriteRun(const uint8_t *data, uint8_t step, uint8_t n)
+{
+    for (; n > 0; n--, data += step) {
+        busWait();
+        GLCD_HostBusWrite(1, *data);
+    }
+}
+
+void GLCD_HostBusReadRun(uint8_t *buf, uint8_t n)
+{
+    for (; n > 0; n--) {
+        busWait();
+        *buf++ = GLCD_HostBusRead(1);
+    }
+}
+
+void GLCD_HostDelay(uint32_t ns)
+{
+    sync();
+    now += ns * 1000ULL;
+}
+
+uint16_t GLCD_HostTimer(void)
+{
+    sync();
+    now += CYCLE_PS; // reading the timer register is an instruction as well
+    return (uint16_t) (now / CYCLE_PS);
+}
+
+void GLCD_HostPowerOn(void)
+{
+    memset(chips, 0, sizeof (chips));
+    memset(&GLCD_HostPins, 0, sizeof (GLCD_HostPins));
+    GLCD_HostPins.rst = 1;
+    last = GLCD_HostPins;
+    now = enRise = resetAt = statsStart = 0;
+    enFall = 0;
+    din = 0;
+    spiChain = 0;
+    spiIn = 0;
+    busChip = 0;
+    GLCD_HostResetStats();
+}
+
+void GLCD_HostHoldReset(uint8_t mask)
+{
+    uint8_t chip;
+
+    for (chip = 0; chip < GLCD_HOST_CHIPS; chip++)
+        chips[chip].held = (mask >> chip) & 1;
+}
+
+void GLCD_HostResetStats(void)
+{
+    sync();
+    memset(&stats, 0, sizeof (stats));
+    statsStart = now;
+}
+
+const GLCD_HostStats *GLCD_HostGetStats(void)
+{
+    sync();
+    stats.time = now - statsStart;
+    return &stats;
+}
+
+uint64_t GLCD_HostTime(void)
+{
+    sync();
+    return now;
+}
+
+uint8_t GLCD_HostPixel(uint16_t x, uint8_t y)
+{
+    HostChip *c = &chips[x / GLCD_HOST_COLUMNS];
+    uint8_t line;
+
+    if (!c->on)
+        return 0;
+    line = (y + c->startLine) % (GLCD_HOST_PAGES * 8);
+    return (c->ram[line / 8][x % GLCD_HOST_COLUMNS] >> (line % 8)) & 1;
+}
+
+uint8_t GLCD_HostByte(uint16_t x, uint8_t page)
+{
+    return chips[x / GLCD_HOST_COLUMNS].ram[page][x % GLCD_HOST_COLUMNS];
+}
+
+void GLCD_HostTrace(GLCD_HostTraceFn fn)
+{
+    sync();
+    trace = fn;
+}
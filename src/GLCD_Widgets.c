@@ -0,0 +1,451 @@
+/*
+  GLCD_Widgets.c - bar, level meter, gauge, chart and big number widgets for the PIC GLCD library
+
+  See GLCD_Widgets.h.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <stdint.h>
+
+#include "GLCD_Widgets.h"
+
+/* sin(k * 90 / 32 degrees) * 255, quarter wave for the gauge needle */
+static const uint8_t GLCD_Sine[33] = {
+    0, 13, 25, 37, 50, 62, 74, 86, 98, 109, 120, 131, 142, 152, 162, 171, 180,
+    189, 197, 205, 212, 219, 225, 231, 236, 240, 244, 247, 250, 252, 254, 255, 255
+};
+
+/* value scaled to 0..span, clamped at max */
+static uint8_t GLCD_Scale(uint16_t value, uint16_t max, uint8_t span)
+{
+    if (max == 0 || value >= max)
+        return span;
+    return (uint32_t) value * span / max;
+}
+
+void GLCD_BarInit(lcdBar *bar, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t flags)
+{
+    GLCD_FillRect(x + 1, y + 1, width - 2, height - 2, WHITE);
+    if (flags & GLCD_WIDGET_ROUND)
+        GLCD_DrawRoundRect(x, y, width, height, height < 8 || width < 8 ? 2 : 3, BLACK);
+    else
+        GLCD_DrawRect(x, y, width, height, BLACK);
+
+    bar->x = x + 2;
+    bar->y = y + 2;
+    bar->width = width - 3;
+    bar->height = height - 3;
+    bar->flags = flags;
+    bar->fill = 0;
+}
+
+/*
+ * Only the columns (or rows) between the old and the new end of the bar are
+ * filled or cleared.
+ */
+void GLCD_BarSet(lcdBar *bar, uint16_t value, uint16_t max)
+{
+    uint8_t fill, lo, hi, color;
+
+    if (bar->flags & GLCD_WIDGET_VERTICAL)
+        fill = GLCD_Scale(value, max, bar->height);
+    else
+        fill = GLCD_Scale(value, max, bar->width);
+    if (fill == bar->fill)
+        return;
+
+    if (fill > bar->fill) {
+        lo = bar->fill;
+        hi = fill;
+        color = BLACK;
+    } else {
+        lo = fill;
+        hi = bar->fill;
+        color = WHITE;
+    }
+    if (bar->flags & GLCD_WIDGET_VERTICAL)
+        GLCD_FillRect(bar->x, bar->y + bar->height - hi, bar->width - 1, hi - lo - 1, color);
+    else
+        GLCD_FillRect(bar->x + lo, bar->y, hi - lo - 1, bar->height - 1, color);
+    bar->fill = fill;
+}
+
+/* Outline of level meter segment i, as x, y, width, height for GLCD_DrawRect() */
+static void GLCD_LevelRect(const lcdLevel *level, uint8_t i, uint8_t *r)
+{
+    uint8_t len = level->pitch - GLCD_LEVEL_GAP;
+
+    if (level->flags & GLCD_WIDGET_VERTICAL) {
+        r[0] = level->x;
+        r[1] = level->y + level->height - i * level->pitch - (len - 1);
+        r[2] = level->width;
+        r[3] = len - 1;
+    } else {
+        r[0] = level->x + i * level->pitch;
+        r[1] = level->y;
+        r[2] = len - 1;
+        r[3] = level->height;
+    }
+}
+
+/* Fills or clears the inside of a segment, leaving its outline */
+static void GLCD_LevelSegment(const lcdLevel *level, uint8_t i, uint8_t color)
+{
+    uint8_t r[4];
+
+    GLCD_LevelRect(level, i, r);
+    GLCD_FillRect(r[0] + 1, r[1] + 1, r[2] - 2, r[3] - 2, color);
+}
+
+void GLCD_LevelInit(lcdLevel *level, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t segments, uint8_t flags)
+{
+    uint8_t i, span, r[4];
+
+    span = (flags & GLCD_WIDGET_VERTICAL) ? height + 1 : width + 1;
+    level->x = x;
+    level->y = y;
+    level->width = width;
+    level->height = height;
+    level->flags = flags;
+    level->segments = segments;
+    level->pitch = (span + GLCD_LEVEL_GAP) / segments;
+    level->lit = 0;
+
+    GLCD_FillRect(x, y, width, height, WHITE);
+    for (i = 0; i < segments; i++) {
+        GLCD_LevelRect(level, i, r);
+        GLCD_DrawRect(r[0], r[1], r[2], r[3], BLACK);
+    }
+}
+
+void GLCD_LevelSet(lcdLevel *level, uint16_t value, uint16_t max)
+{
+    uint8_t lit = GLCD_Scale(value, max, level->segments);
+
+    while (level->lit < lit)
+        GLCD_LevelSegment(level, level->lit++, BLACK);
+    while (level->lit > lit)
+        GLCD_LevelSegment(level, --level->lit, WHITE);
+}
+
+/* Point at length len from the gauge center in needle direction step */
+static void GLCD_GaugePoint(const lcdGauge *gauge, uint8_t step, uint8_t len, uint8_t *x, uint8_t *y)
+{
+    uint8_t dx, dy;
+
+    if (step <= GLCD_GAUGE_STEPS / 2) {
+        dx = ((uint16_t) GLCD_Sine[GLCD_GAUGE_STEPS / 2 - step] * len + 127) / 255;
+        dy = ((uint16_t) GLCD_Sine[step] * len + 127) / 255;
+        *x = gauge->cx - dx;
+    } else {
+        dx = ((uint16_t) GLCD_Sine[step - GLCD_GAUGE_STEPS / 2] * len + 127) / 255;
+        dy = ((uint16_t) GLCD_Sine[GLCD_GAUGE_STEPS - step] * len + 127) / 255;
+        *x = gauge->cx + dx;
+    }
+    *y = gauge->cy - dy;
+}
+
+static void GLCD_GaugeNeedle(const lcdGauge *gauge, uint8_t color)
+{
+    uint8_t x, y;
+
+    GLCD_GaugePoint(gauge, gauge->step, gauge->radius - 4, &x, &y);
+    GLCD_DrawLine(gauge->cx, gauge->cy, x, y, color);
+}
+
+void GLCD_GaugeInit(lcdGauge *gauge, uint8_t cx, uint8_t cy, uint8_t radius)
+{
+    int16_t f = 1 - radius, x = 0, y = radius;
+    uint8_t step, x1, y1, x2, y2;
+
+    gauge->cx = cx;
+    gauge->cy = cy;
+    gauge->radius = radius;
+
+    /* upper half of a midpoint circle */
+    while (x <= y) {
+        GLCD_SetDot(cx - x, cy - y, BLACK);
+        GLCD_SetDot(cx + x, cy - y, BLACK);
+        GLCD_SetDot(cx - y, cy - x, BLACK);
+        GLCD_SetDot(cx + y, cy - x, BLACK);
+        if (f >= 0) {
+            y--;
+            f -= 2 * y;
+        }
+        x++;
+        f += 2 * x + 1;
+    }
+
+    /* scale ticks every quarter */
+    for (step = 0; step <= GLCD_GAUGE_STEPS; step += GLCD_GAUGE_STEPS / 4) {
+        GLCD_GaugePoint(gauge, step, radius - 2, &x1, &y1);
+        GLCD_GaugePoint(gauge, step, radius, &x2, &y2);
+        GLCD_DrawLine(x1, y1, x2, y2, BLACK);
+    }
+
+    gauge->step = 0;
+    GLCD_GaugeNeedle(gauge, BLACK);
+}
+
+/* The old needle is erased and the new one drawn, the scale is left alone */
+void GLCD_GaugeSet(lcdGauge *gauge, uint16_t value, uint16_t max)
+{
+    uint8_t step = GLCD_Scale(value, max, GLCD_GAUGE_STEPS);
+
+    if (step == gauge->step)
+        return;
+    GLCD_GaugeNeedle(gauge, WHITE);
+    gauge->step = step;
+    GLCD_GaugeNeedle(gauge, BLACK);
+}
+
+/* Bits of a page byte for page rows first to last, clipped to the page */
+static uint8_t GLCD_SpanMask(int16_t first, int16_t last)
+{
+    if (last < 0 || first > 7 || first > last)
+        return 0;
+    if (first < 0)
+        first = 0;
+    if (last > 7)
+        last = 7;
+    return (uint8_t) (0xFF << first) & (0xFF >> (7 - last));
+}
+
+/*
+ * Rasterizes columns from to to - 1 of page p into buf and writes them. A
+ * column outside the filled part is blank apart from the gridlines.
+ */
+static void GLCD_ChartColumns(const lcdChart *chart, uint8_t p, uint8_t from, uint8_t to)
+{
+    uint8_t buf[16];
+    uint8_t grid = 0, i, n, slot, col;
+    int16_t top = chart->pages * 8 - 1 - p * 8;    // row of bit 0
+
+    if (chart->gridRows)
+        for (i = 0; i < 8; i++)
+            if (top - i >= 0 && (top - i) % chart->gridRows == 0)
+                grid |= 1 << i;
+
+    while (from < to) {
+        n = to - from < (int) sizeof (buf) ? to - from : (uint8_t) sizeof (buf);
+        for (i = 0; i < n; i++) {
+            col = from + i;
+            buf[i] = (col & 1) ? 0 : grid;
+            if (col >= chart->count)
+                continue;
+            slot = chart->head + col;
+            if (slot >= chart->width)
+                slot -= chart->width;
+            buf[i] |= GLCD_SpanMask(top - chart->ring[2 * slot + 1], top - chart->ring[2 * slot]);
+            if (chart->gridCols && (chart->phase + col) % chart->gridCols == 0)
+                buf[i] |= 0x55;
+        }
+        GLCD_WritePage(chart->x + from, chart->page + p, buf, n);
+        from += n;
+    }
+}
+
+void GLCD_ChartInit(lcdChart *chart, uint8_t x, uint8_t page, uint8_t width, uint8_t pages, uint8_t *ring, uint8_t gridRows, uint8_t gridCols)
+{
+    uint8_t p;
+
+    chart->x = x;
+    chart->page = page;
+    chart->width = width;
+    chart->pages = pages;
+    chart->ring = ring;
+    chart->head = 0;
+    chart->count = 0;
+    chart->last = 0;
+    chart->gridRows = gridRows;
+    chart->gridCols = gridCols;
+    chart->phase = 0;
+
+    for (p = 0; p < pages; p++)
+        GLCD_ChartColumns(chart, p, 0, width);
+}
+
+/*
+ * The new column spans from the previous sample's row to this one, which
+ * draws the vertical connector. Until the chart is full only the new column
+ * is written, after that the whole plot is rewritten one column to the left.
+ */
+void GLCD_ChartAdd(lcdChart *chart, uint16_t value, uint16_t max)
+{
+    uint8_t row, slot, from, to, p;
+
+    row = GLCD_Scale(value, max, chart->pages * 8 - 1);
+    if (chart->count == 0)
+        chart->last = row;
+
+    if (chart->count < chart->width) {
+        slot = chart->count++;
+        from = slot;
+        to = slot + 1;
+    } else {
+        slot = chart->head;
+        if (++chart->head == chart->width)
+            chart->head = 0;
+        if (chart->gridCols && ++chart->phase == chart->gridCols)
+            chart->phase = 0;
+        from = 0;
+        to = chart->width;
+    }
+    chart->ring[2 * slot] = row < chart->last ? row : chart->last;
+    chart->ring[2 * slot + 1] = row < chart->last ? chart->last : row;
+    chart->last = row;
+
+    for (p = 0; p < chart->pages; p++)
+        GLCD_ChartColumns(chart, p, from, to);
+}
+
+/* Seven segments a to g, a on top and then clockwise, g in the middle */
+#define GLCD_SEG_A  0x01
+#define GLCD_SEG_B  0x02
+#define GLCD_SEG_C  0x04
+#define GLCD_SEG_D  0x08
+#define GLCD_SEG_E  0x10
+#define GLCD_SEG_F  0x20
+#define GLCD_SEG_G  0x40
+
+static const uint8_t GLCD_Digits[10] = {
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F
+};
+
+static uint8_t GLCD_BigNumCells(const lcdBigNum *num)
+{
+    return num->digits + ((num->flags & GLCD_WIDGET_SIGNED) ? 1 : 0);
+}
+
+/* First column of a cell, the ones after the decimal point make room for it */
+static uint8_t GLCD_BigNumX(const lcdBigNum *num, uint8_t cell)
+{
+    uint8_t x = num->x + cell * (num->width + GLCD_BIGNUM_GAP);
+
+    if (num->decimals && cell >= GLCD_BigNumCells(num) - num->decimals)
+        x += num->pages + GLCD_BIGNUM_GAP;
+    return x;
+}
+
+/*
+ * Page p of column col of a digit lit with segments. The horizontal strokes
+ * leave the outer columns out and the vertical ones the outer rows, which
+ * rounds the corners.
+ */
+static uint8_t GLCD_DigitByte(const lcdBigNum *num, uint8_t segments, uint8_t col, uint8_t p)
+{
+    uint8_t t = num->pages, w = num->width, h = num->pages * 8;
+    uint8_t mid = (h - t) / 2, upper, lower, data = 0;
+    int16_t top = p * 8;
+
+    if (col > 0 && col < w - 1) {
+        if (segments & GLCD_SEG_A)
+            data |= GLCD_SpanMask(-top, t - 1 - top);
+        if (segments & GLCD_SEG_G)
+            data |= GLCD_SpanMask(mid - top, mid + t - 1 - top);
+        if (segments & GLCD_SEG_D)
+            data |= GLCD_SpanMask(h - t - top, h - 1 - top);
+    }
+    if (col < t || col >= w - t) {
+        upper = col < t ? GLCD_SEG_F : GLCD_SEG_B;
+        lower = col < t ? GLCD_SEG_E : GLCD_SEG_C;
+        if (segments & upper)
+            data |= GLCD_SpanMask(1 - top, mid + (t - 1) / 2 - top);
+        if (segments & lower)
+            data |= GLCD_SpanMask(mid + t / 2 - top, h - 2 - top);
+    }
+    return data;
+}
+
+/* Writes a digit, '-' or ' ' into a cell, page by page */
+static void GLCD_BigNumCell(const lcdBigNum *num, uint8_t cell, char c)
+{
+    uint8_t buf[DISPLAY_PAGES * 4 + 2];
+    uint8_t segments, p, col;
+
+    if (c >= '0' && c <= '9')
+        segments = GLCD_Digits[c - '0'];
+    else
+        segments = c == '-' ? GLCD_SEG_G : 0;
+    for (p = 0; p < num->pages; p++) {
+        for (col = 0; col < num->width; col++)
+            buf[col] = GLCD_DigitByte(num, segments, col, p);
+        GLCD_WritePage(GLCD_BigNumX(num, cell), num->page + p, buf, num->width);
+    }
+}
+
+void GLCD_BigNumInit(lcdBigNum *num, uint8_t x, uint8_t page, uint8_t pages, uint8_t digits, uint8_t decimals, uint8_t flags)
+{
+    uint8_t buf[16];
+    uint8_t cells, point, end, p, i, n, col;
+
+    if (pages > DISPLAY_PAGES)
+        pages = DISPLAY_PAGES;
+    if (digits > GLCD_BIGNUM_MAX)
+        digits = GLCD_BIGNUM_MAX;
+    if (!digits)
+        digits = 1;
+    num->x = x;
+    num->page = page;
+    num->pages = pages;
+    num->digits = digits;
+    num->decimals = decimals < digits ? decimals : digits - 1;
+    num->flags = flags;
+    num->width = pages * 4 + 2;
+
+    /* blank cells and gaps, with the decimal point square in the bottom rows */
+    cells = GLCD_BigNumCells(num);
+    for (i = 0; i < cells; i++)
+        num->shown[i] = ' ';
+    point = GLCD_BigNumX(num, cells - num->decimals) - pages - GLCD_BIGNUM_GAP;
+    end = GLCD_BigNumX(num, cells - 1) + num->width;
+    for (p = 0; p < pages; p++) {
+        for (col = x; col < end; col += n) {
+            n = end - col < (int) sizeof (buf) ? end - col : (uint8_t) sizeof (buf);
+            for (i = 0; i < n; i++)
+                buf[i] = num->decimals && col + i >= point && col + i < point + pages ?
+                    GLCD_SpanMask(pages * 7 - p * 8, pages * 8 - 1 - p * 8) : 0;
+            GLCD_WritePage(col, page + p, buf, n);
+        }
+    }
+}
+
+/*
+ * The value is formatted into the cells first, then only the cells that
+ * differ from what the display shows are written.
+ */
+void GLCD_BigNumSet(lcdBigNum *num, int32_t value)
+{
+    char cell[GLCD_BIGNUM_MAX + 1];
+    uint8_t cells = GLCD_BigNumCells(num), first = cells - num->digits, i;
+    uint8_t negative = value < 0;
+    uint32_t v = negative ? -(uint32_t) value : (uint32_t) value;
+
+    /* digits from the right, at least one before the decimal point */
+    i = cells;
+    do {
+        cell[--i] = '0' + v % 10;
+        v /= 10;
+    } while (i > first && (v || cells - i <= num->decimals || (num->flags & GLCD_WIDGET_ZEROS)));
+
+    if (v || (negative && !(num->flags & GLCD_WIDGET_SIGNED))) {
+        for (i = 0; i < cells; i++)
+            cell[i] = i < first ? ' ' : '-';
+    } else {
+        first = i;
+        while (i > 0)
+            cell[--i] = ' ';
+        if (negative)
+            cell[(num->flags & GLCD_WIDGET_ZEROS) ? 0 : first - 1] = '-';
+    }
+
+    for (i = 0; i < cells; i++) {
+        if (cell[i] != num->shown[i]) {
+            GLCD_BigNumCell(num, i, cell[i]);
+            num->shown[i] = cell[i];
+        }
+    }
+}